@@ -4,11 +4,44 @@ set -eu
 
 warning_flags="-Wall -Wextra -pedantic"
 other_flags="-g -std=c++11"
-libs="-lX11 -lGL -lGLEW"
-files="src/main.cpp src/X11Window.cpp src/Vectors.cpp src/AABB.cpp src/Breakout.cpp src/Utils.cpp"
+# Fused multiply-adds round differently, so builds that contract (FMA
+# targets, aarch64) would not reproduce replays and state hashes.
+fp_flags="-ffp-contract=off"
+libs="-lX11 -lGL -lGLEW -pthread"
+sim_files="src/Arena.cpp src/Grid.cpp src/BlockStore.cpp src/Level.cpp src/Breakout.cpp src/Replay.cpp src/FrameSnapshot.cpp src/GameState.cpp src/Timing.cpp src/Utils.cpp"
+test_files="tests/tests.cpp tests/BlockStoreTests.cpp tests/MathTests.cpp"
+files="src/main.cpp src/X11Window.cpp src/Profiler.cpp src/InstanceStream.cpp src/Renderer.cpp src/Shader.cpp src/ProgramCache.cpp src/ShaderWatcher.cpp src/InputThread.cpp src/LatencyMeter.cpp src/RenderThread.cpp ${sim_files}"
+
+# Builds every shader into the game as a raw string literal, so the game
+# runs from any directory.
+embed_shaders () {
+    mkdir -p gen
+    for shader in shaders/*; do
+        printf '{ "%s", R"glsl(' "${shader#shaders/}"
+        cat "${shader}"
+        echo ")glsl\" },"
+    done > gen/shaders.inc
+}
 
 if [ $# -ne 1 ]; then
-    (set -x; g++ ${warning_flags} ${other_flags} ${files} ${libs})
+    embed_shaders
+    (set -x; g++ ${fp_flags} ${warning_flags} ${other_flags} -Igen ${files} ${libs})
 elif [ $1 = "release" ]; then
-    (set -x; g++ -O2 ${files} ${libs})
+    embed_shaders
+    (set -x; g++ ${fp_flags} -O2 -Igen ${files} ${libs})
+elif [ $1 = "replay" ]; then
+    (set -x; g++ ${fp_flags} -O2 -std=c++11 ${sim_files} src/replay.cpp -o breakout-replay)
+elif [ $1 = "render-replay" ]; then
+    embed_shaders
+    (set -x; g++ ${fp_flags} -O2 -std=c++11 -Igen ${sim_files} src/InstanceStream.cpp src/Renderer.cpp src/Shader.cpp src/ProgramCache.cpp src/OffscreenWindow.cpp src/FrameDumper.cpp src/render_replay.cpp -o breakout-render -lEGL -lGL -lGLEW)
+elif [ $1 = "level-tool" ]; then
+    (set -x; g++ ${fp_flags} -O2 -std=c++11 ${sim_files} src/level_tool.cpp -o breakout-level)
+elif [ $1 = "bench" ]; then
+    (set -x; g++ ${fp_flags} -O2 -std=c++11 ${sim_files} src/Bench.cpp src/bench.cpp -o breakout-bench)
+elif [ $1 = "upload-bench" ]; then
+    (set -x; g++ ${fp_flags} -O2 -std=c++11 ${sim_files} src/InstanceStream.cpp src/OffscreenWindow.cpp src/Bench.cpp src/upload_bench.cpp -o breakout-upload-bench -lEGL -lGL -lGLEW)
+elif [ $1 = "batch-bench" ]; then
+    (set -x; g++ ${fp_flags} -O2 -std=c++11 -pthread ${sim_files} src/ThreadPool.cpp src/BreakoutBatch.cpp src/batch_bench.cpp -o breakout-batch-bench)
+elif [ $1 = "tests" ]; then
+    (set -x; g++ ${fp_flags} ${warning_flags} -O2 -std=c++11 -Isrc ${sim_files} ${test_files} -o breakout-tests && ./breakout-tests)
 fi
@@ -0,0 +1,12 @@
+# Writes every shader in SHADER_DIR to OUTPUT as entries of
+# "embedded_shaders", the way "embed_shaders" in build.sh does. Run with
+# "cmake -DSHADER_DIR=... -DOUTPUT=... -P".
+
+file (GLOB shaders "${SHADER_DIR}/*")
+file (WRITE "${OUTPUT}" "")
+
+foreach (shader IN LISTS shaders)
+  get_filename_component (name "${shader}" NAME)
+  file (READ "${shader}" source)
+  file (APPEND "${OUTPUT}" "{ \"${name}\", R\"glsl(${source})glsl\" },\n")
+endforeach ()
@@ -0,0 +1,18 @@
+# Merges the raw profiles Clang instrumented binaries left in PGO_DIR
+# into the "default.profdata" that "-fprofile-use" reads. Run with
+# "cmake -DLLVM_PROFDATA=... -DPGO_DIR=... -P".
+
+file (GLOB raw_profiles "${PGO_DIR}/*.profraw")
+
+if (NOT raw_profiles)
+  message (FATAL_ERROR "no profiles in ${PGO_DIR}, nothing was trained")
+endif ()
+
+execute_process (COMMAND "${LLVM_PROFDATA}" merge
+                         -output=${PGO_DIR}/default.profdata
+                         ${raw_profiles}
+                 RESULT_VARIABLE result)
+
+if (NOT result EQUAL 0)
+  message (FATAL_ERROR "llvm-profdata failed")
+endif ()
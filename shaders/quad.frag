@@ -1,9 +1,15 @@
 #version 330
 
+flat in vec3 color;
+flat in uint state;
+
 out vec4 output_color;
 
 void
 main ()
 {
-  output_color = vec4 (1.0, 0.0, 0.0, 1.0);
+  // Blocks that take more than one hit are drawn paler, up to four.
+  float pale = state > 1u ? 0.15 * float (min (state - 1u, 3u)) : 0.0;
+
+  output_color = vec4 (mix (color, vec3 (1.0), pale), 1.0);
 }
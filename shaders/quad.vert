@@ -1,10 +1,23 @@
 #version 330
 
 layout (location = 0) in vec2 vertex_pos;
-layout (location = 1) in vec4 aabb;
+// "pos.xy, shape.xy", from half floats.
+layout (location = 1) in vec4 rect;
+// RGB in 0..255, then the state byte: hit points left for blocks, zero
+// for dead ones.
+layout (location = 2) in uvec4 color_state;
+
+flat out vec3 color;
+flat out uint state;
 
 void
 main ()
 {
-  gl_Position = vec4 (aabb.zw * vertex_pos + aabb.xy, 0.0, 1.0);
+  // Without the cull pass dead blocks are drawn too. Collapsed onto a
+  // point they cover no pixels.
+  vec2 shape = color_state.a != 0u ? rect.zw : vec2 (0.0);
+
+  gl_Position = vec4 (shape * vertex_pos + rect.xy, 0.0, 1.0);
+  color = vec3 (color_state.rgb) / 255.0;
+  state = color_state.a;
 }
@@ -1,6 +1,8 @@
 #ifndef AABB_HPP
 #define AABB_HPP
 
+#include <cmath>
+#include <limits>
 #include "Vectors.hpp"
 
 enum Direction
@@ -13,14 +15,152 @@ struct AABB
   Vec2f pos, shape;
 };
 
-bool
-do_intersect (const AABB &x, const AABB &y);
+struct Contact
+{
+  // Fraction of the velocity travelled before touching, in "[0, 1]".
+  float time;
+  // Outward normal of the face that was hit. Both components are set for
+  // a corner hit.
+  Vec2f normal;
+};
+
+constexpr bool
+do_intersect (const AABB &x, const AABB &y)
+{
+  return !(x.pos.x + x.shape.x < y.pos.x
+           || x.pos.x > y.pos.x + y.shape.x
+           || x.pos.y + x.shape.y < y.pos.y
+           || x.pos.y > y.pos.y + y.shape.y);
+}
+
+// "l1" defines line "l1.pos + k * l1.shape, k in ]-inf, inf[", same for
+// "l2". The result satisfies
+// "l1.pos + x * l1.shape == l2.pos + y * l2.shape". Parallel lines have
+// no (or no single) solution and give infinity in both components.
+constexpr Vec2f
+parametric_intersect (const AABB &l1, const AABB &l2)
+{
+  return cross (l1.shape, l2.shape) == 0
+    ? Vec2f { std::numeric_limits<float>::infinity (),
+              std::numeric_limits<float>::infinity () }
+    : Vec2f { cross (l2.pos - l1.pos, l2.shape) / cross (l1.shape, l2.shape),
+              cross (l2.pos - l1.pos, l1.shape) / cross (l1.shape, l2.shape) };
+}
+
+// Linear interpolation from "from" (t == 0) to "to" (t == 1).
+constexpr AABB
+lerp (const AABB &from, const AABB &to, float t)
+{
+  return { from.pos + (to.pos - from.pos) * t,
+           from.shape + (to.shape - from.shape) * t };
+}
+
+inline Direction
+hit_direction (const AABB &static_, const AABB &moving_, const Vec2f &vel)
+{
+  if (moving_.pos.x > static_.pos.x && moving_.pos.y > static_.pos.y)
+    {
+      float lambda =
+        parametric_intersect ({ static_.pos + static_.shape, { 0, -1 } },
+                              { moving_.pos, vel }).x;
+
+      return 0 <= lambda && lambda <= static_.shape.y ? Right : Up;
+    }
+  else
+    {
+      float lambda =
+        parametric_intersect ({ static_.pos, { 0, 1 } },
+                              { moving_.pos + moving_.shape, vel }).x;
+
+      return 0 <= lambda && lambda <= static_.shape.y ? Left : Down;
+    }
+}
+
+// Entry and exit times of the point "pos" moving by "vel" through the
+// slab "[min, max]".
+inline void
+slab_times (float pos, float vel, float min, float max,
+            float &entry, float &exit)
+{
+  if (vel == 0)
+    {
+      float const inf = std::numeric_limits<float>::infinity ();
+      bool const inside = min < pos && pos < max;
+
+      entry = inside ? -inf : inf;
+      exit = inside ? inf : -inf;
+    }
+  else
+    {
+      float const t1 = (min - pos) / vel;
+      float const t2 = (max - pos) / vel;
+
+      entry = std::fmin (t1, t2);
+      exit = std::fmax (t1, t2);
+    }
+}
+
+// Swept test of "moving" travelling by "vel" against "static_". Boxes
+// that already overlap report a contact at time 0 on the face of least
+// penetration, unless "vel" already moves them apart.
+inline bool
+sweep (const AABB &moving,
+       const Vec2f &vel,
+       const AABB &static_,
+       Contact *contact)
+{
+  // Sweep the point "moving.pos" against "static_" grown by the shape of
+  // "moving" (their Minkowski difference).
+  float entry_x, exit_x, entry_y, exit_y;
+
+  slab_times (moving.pos.x, vel.x,
+              static_.pos.x - moving.shape.x,
+              static_.pos.x + static_.shape.x,
+              entry_x, exit_x);
+  slab_times (moving.pos.y, vel.y,
+              static_.pos.y - moving.shape.y,
+              static_.pos.y + static_.shape.y,
+              entry_y, exit_y);
+
+  float const entry = std::fmax (entry_x, entry_y);
+  float const exit = std::fmin (exit_x, exit_y);
+
+  if (!(entry < exit) || exit <= 0 || entry > 1)
+    return false;
+
+  if (entry < 0)
+    {
+      float const left = moving.pos.x + moving.shape.x - static_.pos.x;
+      float const right = static_.pos.x + static_.shape.x - moving.pos.x;
+      float const down = moving.pos.y + moving.shape.y - static_.pos.y;
+      float const up = static_.pos.y + static_.shape.y - moving.pos.y;
+
+      Vec2f const normal =
+        std::fmin (left, right) < std::fmin (down, up)
+        ? Vec2f { left < right ? -1.0f : 1.0f, 0 }
+        : Vec2f { 0, down < up ? -1.0f : 1.0f };
+
+      if (dot (vel, normal) >= 0)
+        return false;
+
+      contact->time = 0;
+      contact->normal = normal;
+
+      return true;
+    }
+
+  // Entering both slabs at (nearly) the same time is a corner hit.
+  float const corner_epsilon = 1e-5f;
+
+  contact->time = entry;
+  contact->normal = { 0, 0 };
 
-Vec2f
-parametric_intersect (const AABB &aabb_as_line1,
-                      const AABB &aabb_as_line2);
+  if (entry_x >= entry_y - corner_epsilon)
+    contact->normal.x = vel.x > 0 ? -1 : 1;
+  if (entry_y >= entry_x - corner_epsilon)
+    contact->normal.y = vel.y > 0 ? -1 : 1;
 
-Direction
-hit_direction (const AABB &static_, const AABB &moving_, const Vec2f &vel);
+  return true;
+}
 
 #endif // AABB_HPP
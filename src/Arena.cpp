@@ -0,0 +1,119 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "Utils.hpp"
+#include "Arena.hpp"
+
+#define ARENA_ALIGNMENT 64
+
+static char *
+map_anonymous (void *at, size_t size, int flags)
+{
+  void *memory = mmap (at,
+                       size,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | flags,
+                       -1,
+                       0);
+
+  if (memory == MAP_FAILED)
+    {
+      std::fprintf (stderr,
+                    "ERROR: failed to reserve %zu bytes.\n",
+                    size);
+      std::exit (EXIT_FAILURE);
+    }
+
+  return (char *)memory;
+}
+
+Arena
+create_arena (size_t reserved)
+{
+  Arena arena;
+
+  track_allocation ();
+
+  arena.base = map_anonymous (NULL, reserved, 0);
+  arena.reserved = reserved;
+  arena.used = 0;
+  arena.mapped = 0;
+
+  return arena;
+}
+
+void
+destroy_arena (Arena &arena)
+{
+  munmap (arena.base, arena.reserved);
+  arena.base = NULL;
+  arena.reserved = arena.used = arena.mapped = 0;
+}
+
+static size_t
+align_up (size_t offset, size_t alignment)
+{
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+static size_t
+claim (Arena &arena, size_t size, size_t alignment)
+{
+  size_t const offset = align_up (arena.used, alignment);
+
+  if (offset > arena.reserved || arena.reserved - offset < size)
+    {
+      std::fprintf (stderr,
+                    "ERROR: arena of %zu bytes is out of space for %zu "
+                    "more.\n",
+                    arena.reserved,
+                    size);
+      std::exit (EXIT_FAILURE);
+    }
+
+  arena.used = offset + size;
+
+  return offset;
+}
+
+void *
+push (Arena &arena, size_t size)
+{
+  return arena.base + claim (arena, size, ARENA_ALIGNMENT);
+}
+
+void *
+push_file (Arena &arena, int fd, size_t size)
+{
+  size_t const page_size = sysconf (_SC_PAGESIZE);
+  size_t const offset = claim (arena, align_up (size, page_size), page_size);
+
+  void *memory = mmap (arena.base + offset,
+                       size,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_FIXED,
+                       fd,
+                       0);
+
+  if (memory == MAP_FAILED)
+    return NULL;
+
+  if (arena.used > arena.mapped)
+    arena.mapped = arena.used;
+
+  return memory;
+}
+
+void
+reset_arena (Arena &arena)
+{
+  // A file mapping left in place would keep the file open, and fault
+  // once the file shrinks underneath it.
+  if (arena.mapped != 0)
+    map_anonymous (arena.base, arena.mapped, MAP_FIXED);
+
+  arena.used = 0;
+  arena.mapped = 0;
+}
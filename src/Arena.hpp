@@ -0,0 +1,55 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+
+// Enough for the temporaries of loading the largest levels.
+#define SCRATCH_ARENA_SIZE ((size_t)1 << 30)
+
+// Linear allocator over one reservation of address space. Pages are
+// only backed once touched, so arenas reserve generously. Nothing is
+// freed on its own: everything goes at once in "reset_arena".
+struct Arena
+{
+  char *base;
+  size_t reserved;
+  size_t used;
+  // End of the part of the reservation files were mapped into.
+  size_t mapped;
+};
+
+Arena
+create_arena (size_t reserved);
+
+void
+destroy_arena (Arena &arena);
+
+// Aligned to 64 bytes, which suits cache lines and SIMD loads. Exits
+// when the reservation runs out.
+void *
+push (Arena &arena, size_t size);
+
+// Maps "size" bytes of file "fd" privately on top of the arena, so they
+// can be read in place and written to without reaching the file.
+void *
+push_file (Arena &arena, int fd, size_t size);
+
+// Drops everything at once, without returning any memory. Parts files
+// were mapped into are replaced by anonymous memory again.
+void
+reset_arena (Arena &arena);
+
+// Gives back everything pushed onto "arena" during its lifetime.
+struct ArenaScope
+{
+  Arena &arena;
+  size_t used;
+
+  explicit ArenaScope (Arena &arena) : arena (arena), used (arena.used) { }
+  ~ArenaScope () { arena.used = used; }
+
+  ArenaScope (const ArenaScope &) = delete;
+  ArenaScope &operator= (const ArenaScope &) = delete;
+};
+
+#endif // ARENA_HPP
@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include "Utils.hpp"
+#include "Bench.hpp"
+
+Bench
+create_bench (int argc, char **argv)
+{
+  Bench bench;
+
+  bench.warmup = 3;
+  bench.repetitions = 20;
+  bench.filter = NULL;
+  bench.first = true;
+
+  for (int i = 1; i < argc; i++)
+    {
+      if (std::strcmp (argv[i], "--warmup") == 0 && i + 1 < argc)
+        bench.warmup = std::atol (argv[++i]);
+      else if (std::strcmp (argv[i], "--repetitions") == 0 && i + 1 < argc)
+        bench.repetitions = std::atol (argv[++i]);
+      else if (std::strcmp (argv[i], "--filter") == 0 && i + 1 < argc)
+        bench.filter = argv[++i];
+      else
+        bench.repetitions = 0;
+    }
+
+  if (bench.repetitions == 0)
+    {
+      std::fprintf (stderr,
+                    "usage: %s [--warmup N] [--repetitions N] "
+                    "[--filter NAME]\n",
+                    argv[0]);
+      std::exit (EXIT_FAILURE);
+    }
+
+  bench.samples =
+    (double *)malloc_or_exit (bench.repetitions * sizeof (double));
+
+  std::printf ("{\n  \"warmup\": %zu,\n  \"repetitions\": %zu,\n"
+               "  \"benchmarks\": [\n",
+               bench.warmup,
+               bench.repetitions);
+
+  return bench;
+}
+
+void
+finish_bench (Bench &bench)
+{
+  std::printf ("\n  ]\n}\n");
+  std::free (bench.samples);
+}
+
+static int
+compare_doubles (const void *a, const void *b)
+{
+  double const x = *(const double *)a, y = *(const double *)b;
+
+  return (x > y) - (x < y);
+}
+
+void
+report (Bench &bench, const char *name, size_t bricks, size_t ops)
+{
+  double sum = 0;
+
+  for (size_t i = 0; i < bench.repetitions; i++)
+    sum += bench.samples[i];
+
+  double const mean = sum / bench.repetitions;
+  double variance = 0;
+
+  for (size_t i = 0; i < bench.repetitions; i++)
+    variance += (bench.samples[i] - mean) * (bench.samples[i] - mean);
+
+  // Sample variance; a single repetition has none to speak of.
+  variance = bench.repetitions > 1 ? variance / (bench.repetitions - 1) : 0;
+
+  std::qsort (bench.samples,
+              bench.repetitions,
+              sizeof (double),
+              compare_doubles);
+
+  std::printf ("%s    { \"name\": \"%s\", \"bricks\": %zu, "
+               "\"ops_per_repetition\": %zu,\n"
+               "      \"ns_per_op\": { \"mean\": %.6g, \"variance\": %.6g, "
+               "\"stddev\": %.6g, \"min\": %.6g, \"median\": %.6g, "
+               "\"max\": %.6g } }",
+               bench.first ? "" : ",\n",
+               name,
+               bricks,
+               ops,
+               mean,
+               variance,
+               std::sqrt (variance),
+               bench.samples[0],
+               bench.samples[bench.repetitions / 2],
+               bench.samples[bench.repetitions - 1]);
+  std::fflush (stdout);
+  bench.first = false;
+}
@@ -0,0 +1,60 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Microbenchmarks printed as one JSON document on stdout. Every
+// benchmark runs "--warmup" untimed repetitions, then "--repetitions"
+// timed ones; statistics are over the time per operation of each
+// repetition. "--filter" runs only the benchmarks whose name contains
+// it.
+
+static size_t const bench_brick_counts[] = { 30, 1000, 10000, 100000 };
+
+// Operations per repetition of the cheap benchmarks, so that a
+// repetition is long enough for the clock.
+#define MIN_OPS_PER_REPETITION 1000000
+
+struct Bench
+{
+  size_t warmup, repetitions;
+  const char *filter;
+  double *samples;
+  bool first;
+};
+
+// Parses the command line, exiting with a usage message on anything it
+// does not know, and opens the JSON document.
+Bench
+create_bench (int argc, char **argv);
+
+// Closes the JSON document.
+void
+finish_bench (Bench &bench);
+
+// Prints the statistics of the samples "measure" took.
+void
+report (Bench &bench, const char *name, size_t bricks, size_t ops);
+
+// "run" does one repetition of "ops" operations and returns how long
+// the part worth timing took, in nanoseconds, so it can do its own
+// setup.
+template <typename Run>
+void
+measure (Bench &bench, const char *name, size_t bricks, size_t ops, Run run)
+{
+  if (bench.filter != NULL && std::strstr (name, bench.filter) == NULL)
+    return;
+
+  for (size_t i = 0; i < bench.warmup; i++)
+    run ();
+
+  for (size_t i = 0; i < bench.repetitions; i++)
+    bench.samples[i] = (double)run () / ops;
+
+  report (bench, name, bricks, ops);
+}
+
+#endif // BENCH_HPP
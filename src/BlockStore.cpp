@@ -0,0 +1,220 @@
+#include <cstring>
+#if defined (__AVX__) || defined (__SSE2__)
+#include <immintrin.h>
+#endif
+#include "BlockStore.hpp"
+
+// Arrays are padded so the kernels can load a full vector starting at
+// any block, and the alive mask so "alive_bits" can read past the end.
+#define LANES 8
+
+static size_t
+padded_count (size_t count)
+{
+  return (count + LANES - 1) / LANES * LANES + LANES;
+}
+
+static size_t
+alive_words (size_t count)
+{
+  return padded_count (count) / 32 + 2;
+}
+
+size_t
+block_store_size (size_t count)
+{
+  return (4 * padded_count (count) * sizeof (float)
+          + alive_words (count) * sizeof (uint32_t)
+          + count * sizeof (uint8_t));
+}
+
+BlockStore
+place_block_store (void *memory, size_t count, size_t live_count)
+{
+  BlockStore store;
+
+  size_t const padded = padded_count (count);
+
+  store.min_x = (float *)memory;
+  store.min_y = store.min_x + padded;
+  store.max_x = store.min_y + padded;
+  store.max_y = store.max_x + padded;
+  store.alive = (uint32_t *)(store.max_y + padded);
+  store.count = count;
+  store.hit_points = (uint8_t *)(store.alive + alive_words (count));
+  store.live_count = live_count;
+
+  return store;
+}
+
+BlockStore
+create_block_store (Arena &arena, size_t count)
+{
+  size_t const size = block_store_size (count);
+  void *memory = push (arena, size);
+
+  std::memset (memory, 0, size);
+
+  return place_block_store (memory, count, 0);
+}
+
+void
+set_block (BlockStore &store, size_t index, const AABB &block)
+{
+  store.min_x[index] = block.pos.x;
+  store.min_y[index] = block.pos.y;
+  store.max_x[index] = block.pos.x + block.shape.x;
+  store.max_y[index] = block.pos.y + block.shape.y;
+  store.hit_points[index] = 1;
+
+  if (!is_alive (store, index))
+    {
+      store.alive[index / 32] |= uint32_t (1) << (index % 32);
+      store.live_count++;
+    }
+}
+
+void
+kill_block (BlockStore &store, size_t index)
+{
+  store.alive[index / 32] &= ~(uint32_t (1) << (index % 32));
+  store.live_count--;
+}
+
+AABB
+get_block (const BlockStore &store, size_t index)
+{
+  return { { store.min_x[index], store.min_y[index] },
+           { store.max_x[index] - store.min_x[index],
+             store.max_y[index] - store.min_y[index] } };
+}
+
+size_t
+find_overlapping_scalar (const BlockStore &store,
+                         const AABB &area,
+                         size_t first,
+                         size_t last,
+                         uint32_t *hits)
+{
+  float const min_x = area.pos.x, max_x = area.pos.x + area.shape.x;
+  float const min_y = area.pos.y, max_y = area.pos.y + area.shape.y;
+
+  size_t hit_count = 0;
+
+  for (size_t i = first; i < last; i++)
+    {
+      if (is_alive (store, i)
+          && max_x >= store.min_x[i] && min_x <= store.max_x[i]
+          && max_y >= store.min_y[i] && min_y <= store.max_y[i])
+        hits[hit_count++] = i;
+    }
+
+  return hit_count;
+}
+
+#if defined (__AVX__) || defined (__SSE2__)
+
+// Alive bits of blocks "[index, index + LANES[".
+static uint32_t
+alive_bits (const BlockStore &store, size_t index)
+{
+  size_t const word = index / 32;
+  uint64_t const pair =
+    store.alive[word] | (uint64_t)store.alive[word + 1] << 32;
+
+  return (pair >> (index % 32)) & ((1u << LANES) - 1);
+}
+
+static size_t
+append_hits (uint32_t mask, size_t index, uint32_t *hits)
+{
+  size_t hit_count = 0;
+
+  for (; mask != 0; mask &= mask - 1)
+    hits[hit_count++] = index + __builtin_ctz (mask);
+
+  return hit_count;
+}
+
+#endif
+
+size_t
+find_overlapping (const BlockStore &store,
+                  const AABB &area,
+                  size_t first,
+                  size_t last,
+                  uint32_t *hits)
+{
+#if defined (__AVX__)
+  __m256 const min_x = _mm256_set1_ps (area.pos.x);
+  __m256 const min_y = _mm256_set1_ps (area.pos.y);
+  __m256 const max_x = _mm256_set1_ps (area.pos.x + area.shape.x);
+  __m256 const max_y = _mm256_set1_ps (area.pos.y + area.shape.y);
+
+  size_t hit_count = 0;
+  size_t i = first;
+
+  for (; i < last; i += 8)
+    {
+      __m256 overlap =
+        _mm256_and_ps (_mm256_cmp_ps (max_x,
+                                      _mm256_loadu_ps (store.min_x + i),
+                                      _CMP_GE_OQ),
+                       _mm256_cmp_ps (min_x,
+                                      _mm256_loadu_ps (store.max_x + i),
+                                      _CMP_LE_OQ));
+      overlap =
+        _mm256_and_ps (overlap,
+                       _mm256_cmp_ps (max_y,
+                                      _mm256_loadu_ps (store.min_y + i),
+                                      _CMP_GE_OQ));
+      overlap =
+        _mm256_and_ps (overlap,
+                       _mm256_cmp_ps (min_y,
+                                      _mm256_loadu_ps (store.max_y + i),
+                                      _CMP_LE_OQ));
+
+      uint32_t mask = _mm256_movemask_ps (overlap) & alive_bits (store, i);
+
+      if (last - i < 8)
+        mask &= (1u << (last - i)) - 1;
+
+      hit_count += append_hits (mask, i, hits + hit_count);
+    }
+
+  return hit_count;
+#elif defined (__SSE2__)
+  __m128 const min_x = _mm_set1_ps (area.pos.x);
+  __m128 const min_y = _mm_set1_ps (area.pos.y);
+  __m128 const max_x = _mm_set1_ps (area.pos.x + area.shape.x);
+  __m128 const max_y = _mm_set1_ps (area.pos.y + area.shape.y);
+
+  size_t hit_count = 0;
+  size_t i = first;
+
+  for (; i < last; i += 4)
+    {
+      __m128 overlap =
+        _mm_and_ps (_mm_cmpge_ps (max_x, _mm_loadu_ps (store.min_x + i)),
+                    _mm_cmple_ps (min_x, _mm_loadu_ps (store.max_x + i)));
+      overlap =
+        _mm_and_ps (overlap,
+                    _mm_cmpge_ps (max_y, _mm_loadu_ps (store.min_y + i)));
+      overlap =
+        _mm_and_ps (overlap,
+                    _mm_cmple_ps (min_y, _mm_loadu_ps (store.max_y + i)));
+
+      uint32_t mask =
+        _mm_movemask_ps (overlap) & alive_bits (store, i) & 0xf;
+
+      if (last - i < 4)
+        mask &= (1u << (last - i)) - 1;
+
+      hit_count += append_hits (mask, i, hits + hit_count);
+    }
+
+  return hit_count;
+#else
+  return find_overlapping_scalar (store, area, first, last, hits);
+#endif
+}
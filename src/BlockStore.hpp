@@ -0,0 +1,78 @@
+#ifndef BLOCK_STORE_HPP
+#define BLOCK_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "AABB.hpp"
+#include "Arena.hpp"
+
+// Blocks as separate coordinate arrays so that several of them can be
+// tested against one box per instruction. Block "i" is alive if bit
+// "i % 32" of "alive[i / 32]" is set.
+//
+// Blocks never move within the store: the grid files them by index, and
+// the renderer draws them in store order, culling dead ones with the
+// alive mask.
+//
+// All arrays live in one block of "block_store_size" bytes starting at
+// "min_x", so a store can be copied, saved and mapped back as a whole.
+struct BlockStore
+{
+  float *min_x, *min_y, *max_x, *max_y;
+  uint32_t *alive;
+  size_t count;
+  // Blocks whose alive bit is set.
+  size_t live_count;
+
+  // Hits left before the block breaks.
+  uint8_t *hit_points;
+};
+
+size_t
+block_store_size (size_t count);
+
+// Lays the arrays of a store of "count" blocks out over "memory", which
+// already holds their contents.
+BlockStore
+place_block_store (void *memory, size_t count, size_t live_count);
+
+// All blocks start out dead.
+BlockStore
+create_block_store (Arena &arena, size_t count);
+
+// Dead blocks come alive, with one hit point.
+void
+set_block (BlockStore &store, size_t index, const AABB &block);
+
+AABB
+get_block (const BlockStore &store, size_t index);
+
+inline bool
+is_alive (const BlockStore &store, size_t index)
+{
+  return (store.alive[index / 32] >> (index % 32)) & 1;
+}
+
+void
+kill_block (BlockStore &store, size_t index);
+
+// Writes to "hits" the indices in "[first, last[" of the live blocks
+// that intersect "area", as "do_intersect" would, in increasing order.
+// "hits" must have room for "last - first" indices. Returns the number
+// of hits.
+size_t
+find_overlapping (const BlockStore &store,
+                  const AABB &area,
+                  size_t first,
+                  size_t last,
+                  uint32_t *hits);
+
+// Same, one block at a time. Used on targets without SSE/AVX.
+size_t
+find_overlapping_scalar (const BlockStore &store,
+                         const AABB &area,
+                         size_t first,
+                         size_t last,
+                         uint32_t *hits);
+
+#endif // BLOCK_STORE_HPP
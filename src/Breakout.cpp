@@ -1,149 +1,417 @@
+#include <cmath>
+#include <algorithm>
 #include "Utils.hpp"
 #include "Breakout.hpp"
 
+// Ball grid cells are at least this large, which bounds the grid to
+// 64x64 cells over the playing field however small the balls are.
+#define MIN_BALL_CELL_SIZE (2.0f / 64)
+
 Breakout
-create_breakout (void)
+create_breakout (Arena &arena,
+                 const Level &level,
+                 uint64_t seed,
+                 size_t ball_capacity)
 {
   static_assert (sizeof (AABB) == 4 * sizeof (float), ":(");
 
   Breakout game;
 
-  game.block_count = 6 * 5;
-  game.blocks = (AABB *)malloc_or_exit (game.block_count * sizeof (AABB));
+  game.tick = 0;
+  // Any seed maps to a valid, non-zero state.
+  game.rng = seed * 0x9e3779b97f4a7c15 | 1;
+
+  game.blocks = level.blocks;
+  game.grid = level.grid;
+  game.level_fingerprint = level.fingerprint;
 
-  game.slab = { { 0.5, -0.8 }, { 0.3, 0.016 } };
+  game.slab = level.slab;
   game.slab_vel = { 0.03, 0.0 };
 
-  game.ball = { { 0.0, -0.8 }, { 0.05, 0.05 } };
-  game.ball_vel = { 0.01, 0.01 };
+  // Cells as large as a ball, over the whole playing field.
+  BlockGrid &ball_grid = game.ball_grid;
+  float const cell_size =
+    std::max (std::max (level.ball.shape.x, level.ball.shape.y),
+              MIN_BALL_CELL_SIZE);
 
-  glCreateVertexArrays (1, &game.vertex_array);
-  glCreateBuffers (2, (gluint *)game.buffer);
+  ball_grid.origin = { -1, -1 };
+  ball_grid.cell_size = { cell_size, cell_size };
+  ball_grid.columns = ball_grid.rows = (int32_t)std::ceil (2 / cell_size);
 
-  {
-    auto vertex_shader =
-      create_shader (GL_VERTEX_SHADER, "shaders/quad.vert");
-    auto fragment_shader =
-      create_shader (GL_FRAGMENT_SHADER, "shaders/quad.frag");
-    game.program =
-      create_program (vertex_shader, fragment_shader);
+  // Whole pool in one push, nothing is allocated while playing.
+  game.ball_capacity = ball_capacity < 1 ? 1 : ball_capacity;
 
-    glDeleteShader (vertex_shader);
-    glDeleteShader (fragment_shader);
-  }
+  size_t const aabbs_size = game.ball_capacity * sizeof (AABB);
+  size_t const vels_size = game.ball_capacity * sizeof (Vec2f);
+  size_t const order_size = game.ball_capacity * sizeof (uint32_t);
+  char *memory =
+    (char *)push (arena,
+                  2 * aabbs_size + vels_size + order_size
+                  + block_grid_size (ball_grid));
 
-  glBindVertexArray (game.vertex_array);
+  game.balls = (AABB *)memory;
+  game.prev_balls = (AABB *)(memory + aabbs_size);
+  game.ball_vels = (Vec2f *)(memory + 2 * aabbs_size);
+  game.ball_order = (uint32_t *)(memory + 2 * aabbs_size + vels_size);
+  place_block_grid (ball_grid,
+                    memory + 2 * aabbs_size + vels_size + order_size);
 
-  glBindBuffer (GL_ARRAY_BUFFER, game.buffer[0]);
-  glVertexAttribPointer (0, 2, GL_FLOAT, GL_FALSE, 0, (void *)0);
-  glEnableVertexAttribArray (0);
+  game.ball_count = 0;
+  spawn_ball (game,
+              level.ball,
+              { random_u32 (game) & 1 ? 0.01f : -0.01f, 0.01 });
 
-  glBindBuffer (GL_ARRAY_BUFFER, game.buffer[1]);
-  glVertexAttribPointer (1, 4, GL_FLOAT, GL_FALSE, 0, (void *)0);
-  glEnableVertexAttribArray (1);
-  glVertexAttribDivisor (1, 1);
+  game.prev_slab = game.slab;
 
-  {
-    Vec2f quad[4] = { { 0.0, 0.0 },
-                      { 1.0, 0.0 },
-                      { 0.0, 1.0 },
-                      { 1.0, 1.0 } };
+  game.dirty.count = 0;
+  mark_dirty (game, 0, game.blocks.count);
 
-    glBindBuffer (GL_ARRAY_BUFFER, game.buffer[0]);
-    glBufferData (GL_ARRAY_BUFFER, sizeof (quad), quad, GL_STATIC_DRAW);
-  }
+  return game;
+}
 
-  {
-    float x_offset = 0.04, y_offset = 0.04;
-    AABB block =
-      { { -1 + x_offset, 1 - y_offset },
-        { (2 - (6 + 1) * x_offset) / 6, 0.05 } };
+bool
+spawn_ball (Breakout &game, const AABB &ball, const Vec2f &vel)
+{
+  if (game.ball_count == game.ball_capacity)
+    return false;
+
+  size_t const i = game.ball_count++;
+
+  game.balls[i] = ball;
+  game.prev_balls[i] = ball;
+  game.ball_vels[i] = vel;
+
+  return true;
+}
+
+void
+add_range (DirtyList &list, uint32_t first, uint32_t count)
+{
+  uint32_t const last = first + count;
+
+  for (size_t i = 0; i < list.count; i++)
+    {
+      InstanceRange &range = list.ranges[i];
+
+      if (first <= range.first + range.count && range.first <= last)
+        {
+          uint32_t const range_last = range.first + range.count;
+          range.first = first < range.first ? first : range.first;
+          range.count =
+            (last > range_last ? last : range_last) - range.first;
+
+          return;
+        }
+    }
+
+  if (list.count < DirtyList::max_ranges)
+    {
+      list.ranges[list.count++] = { first, count };
+
+      return;
+    }
 
-    block.pos.y -= block.shape.y;
+  // Out of slots: collapse everything into one covering range. Uploading
+  // a few clean instances is cheaper than tracking them.
+  uint32_t range_last = last;
 
-    for (size_t i = 0; i < game.block_count; )
+  for (size_t i = 0; i < list.count; i++)
+    {
+      InstanceRange const &other = list.ranges[i];
+      first = other.first < first ? other.first : first;
+      range_last = (other.first + other.count > range_last
+                    ? other.first + other.count : range_last);
+    }
+
+  list.ranges[0] = { first, range_last - first };
+  list.count = 1;
+}
+
+void
+mark_dirty (Breakout &game, uint32_t first, uint32_t count)
+{
+  add_range (game.dirty, first, count);
+}
+
+void
+handle_input (Breakout &game, Input input)
+{
+  switch (input)
+    {
+    case Input_Left:
+      if (game.slab.pos.x > -1)
+        {
+          game.slab.pos -= game.slab_vel;
+        }
+      break;
+    case Input_Right:
+      if (game.slab.pos.x + game.slab.shape.x < 1)
+        {
+          game.slab.pos += game.slab_vel;
+        }
+      break;
+    case Input_SpawnBall:
       {
-        game.blocks[i] = block;
-
-        if (++i % 6 != 0)
-          block.pos.x += x_offset + block.shape.x;
-        else
-          {
-            block.pos.x = -1 + x_offset;
-            block.pos.y -= y_offset + block.shape.y;
-          }
+        // Launched up from the middle of the slab, in a random direction.
+        AABB const &slab = game.slab;
+        Vec2f const shape = game.balls[0].shape;
+        AABB const ball =
+          { { slab.pos.x + (slab.shape.x - shape.x) / 2,
+              slab.pos.y + slab.shape.y },
+            shape };
+        float const speed_x = 0.005f + (random_u32 (game) % 1024) * 1e-5f;
+
+        spawn_ball (game,
+                    ball,
+                    { random_u32 (game) & 1 ? speed_x : -speed_x, 0.01 });
       }
-  }
+      break;
+    }
+}
 
-  glBindBuffer (GL_ARRAY_BUFFER, game.buffer[1]);
-  glBufferData (GL_ARRAY_BUFFER,
-                (game.block_count + 2) * sizeof (AABB),
-                NULL,
-                GL_DYNAMIC_DRAW);
+uint32_t
+random_u32 (Breakout &game)
+{
+  game.rng ^= game.rng >> 12;
+  game.rng ^= game.rng << 25;
+  game.rng ^= game.rng >> 27;
 
-  glBufferSubData (GL_ARRAY_BUFFER,
-                   Breakout::slab_offset,
-                   sizeof (AABB),
-                   &game.slab);
+  return (game.rng * 0x2545f4914f6cdd1d) >> 32;
+}
 
-  glBufferSubData (GL_ARRAY_BUFFER,
-                   Breakout::ball_offset,
-                   sizeof (AABB),
-                   &game.ball);
+uint64_t
+hash_state (const Breakout &game)
+{
+  uint64_t hash = FNV1A_OFFSET_BASIS;
+
+  hash = fnv1a (hash, &game.tick, sizeof (game.tick));
+  hash = fnv1a (hash, &game.rng, sizeof (game.rng));
+  hash = fnv1a (hash, &game.slab, sizeof (game.slab));
+  hash = fnv1a (hash, &game.slab_vel, sizeof (game.slab_vel));
+  hash = fnv1a (hash, &game.ball_count, sizeof (game.ball_count));
+  hash = fnv1a (hash, game.balls, game.ball_count * sizeof (*game.balls));
+  hash = fnv1a (hash,
+                game.ball_vels,
+                game.ball_count * sizeof (*game.ball_vels));
+
+  BlockStore const &blocks = game.blocks;
+
+  hash = fnv1a (hash, &blocks.live_count, sizeof (blocks.live_count));
+  hash = fnv1a (hash,
+                blocks.alive,
+                (blocks.count + 31) / 32 * sizeof (*blocks.alive));
+  hash = fnv1a (hash, blocks.hit_points, blocks.count);
+
+  return hash;
+}
 
-  glBufferSubData (GL_ARRAY_BUFFER,
-                   Breakout::block_offset,
-                   game.block_count * sizeof (AABB),
-                   game.blocks);
+// Walls around the playing field, thick enough that no ball gets past
+// them in one tick.
+static AABB const walls[4] =
+  {
+   { { -2, -2 }, { 1, 4 } },
+   { { 1, -2 }, { 1, 4 } },
+   { { -2, -2 }, { 4, 1 } },
+   { { -2, 1 }, { 4, 1 } }
+  };
+
+// Contacts closer in time than this are resolved together, so a ball
+// hitting the seam between two blocks bounces once and breaks both.
+#define SIMULTANEOUS_EPSILON 1e-5f
+#define MAX_SIMULTANEOUS_BLOCKS 4
+#define MAX_CONTACTS_PER_TICK 8
+#define OVERLAP_BATCH 256
+
+struct EarliestContact
+{
+  Contact contact;
+  uint32_t blocks[MAX_SIMULTANEOUS_BLOCKS];
+  size_t block_count;
+};
+
+static void
+consider (EarliestContact &earliest, const Contact &contact,
+          uint32_t block, bool is_block)
+{
+  if (contact.time < earliest.contact.time - SIMULTANEOUS_EPSILON)
+    {
+      earliest.contact = contact;
+      earliest.block_count = 0;
+    }
+  else if (contact.time <= earliest.contact.time + SIMULTANEOUS_EPSILON)
+    {
+      if (contact.normal.x != 0)
+        earliest.contact.normal.x = contact.normal.x;
+      if (contact.normal.y != 0)
+        earliest.contact.normal.y = contact.normal.y;
+    }
+  else
+    return;
 
-  return game;
+  if (is_block && earliest.block_count < MAX_SIMULTANEOUS_BLOCKS)
+    earliest.blocks[earliest.block_count++] = block;
 }
 
-void
-resolve_collisions (Breakout &game)
+static void
+find_earliest_contact (const Breakout &game,
+                       const AABB &ball,
+                       const Vec2f &step,
+                       EarliestContact &earliest)
 {
-  for (size_t i = 0; i < game.block_count; i++)
+  Contact contact;
+
+  earliest.contact = { 2, { 0, 0 } };
+  earliest.block_count = 0;
+
+  for (auto const &wall : walls)
+    if (sweep (ball, step, wall, &contact))
+      consider (earliest, contact, 0, false);
+
+  if (sweep (ball, step, game.slab, &contact))
+    consider (earliest, contact, 0, false);
+
+  // Everything the ball covers during "step".
+  AABB const swept =
+    { { step.x < 0 ? ball.pos.x + step.x : ball.pos.x,
+        step.y < 0 ? ball.pos.y + step.y : ball.pos.y },
+      { ball.shape.x + (step.x < 0 ? -step.x : step.x),
+        ball.shape.y + (step.y < 0 ? -step.y : step.y) } };
+
+  BlockGrid const &grid = game.grid;
+  CellRange const range = cells_overlapping (grid, swept);
+
+  uint32_t hits[OVERLAP_BATCH];
+
+  for (int32_t y = range.y0; y <= range.y1 && range.x0 <= range.x1; y++)
     {
-      AABB &block = game.blocks[i];
+      if (grid.row_live[y] == 0)
+        continue;
+
+      size_t const row = (size_t)y * grid.columns;
+      size_t const last = grid.cell_first[row + range.x1 + 1];
 
-      if (do_intersect (game.ball, block))
+      for (size_t first = grid.cell_first[row + range.x0];
+           first < last;
+           first += OVERLAP_BATCH)
         {
-          switch (hit_direction (block, game.ball, game.ball_vel))
+          size_t const batch_last =
+            last - first < OVERLAP_BATCH ? last : first + OVERLAP_BATCH;
+          size_t const hit_count =
+            find_overlapping (game.blocks, swept, first, batch_last, hits);
+
+          for (size_t i = 0; i < hit_count; i++)
             {
-            case Left:
-            case Right:
-              game.ball_vel.x = -game.ball_vel.x;
-              break;
-            case Down:
-            case Up:
-              game.ball_vel.y = -game.ball_vel.y;
-              break;
+              AABB const block = get_block (game.blocks, hits[i]);
+
+              if (sweep (ball, step, block, &contact))
+                consider (earliest, contact, hits[i], true);
             }
+        }
+    }
+}
 
-          block.pos = { -2, -2 };
+// Moves ball "b" by its velocity, bouncing off everything but other
+// balls on the way in the order it meets it.
+static void
+move_ball (Breakout &game, size_t b)
+{
+  AABB &ball = game.balls[b];
+  Vec2f &vel = game.ball_vels[b];
+  float remaining = 1;
 
-          glBindBuffer (GL_ARRAY_BUFFER, game.buffer[1]);
-          glBufferSubData (GL_ARRAY_BUFFER,
-                           Breakout::block_offset + i * sizeof (AABB),
-                           sizeof (AABB),
-                           &game.blocks[i]);
+  for (int i = 0; i < MAX_CONTACTS_PER_TICK && remaining > 0; i++)
+    {
+      Vec2f const step = vel * remaining;
+      EarliestContact earliest;
 
-          break;
+      find_earliest_contact (game, ball, step, earliest);
+
+      if (earliest.contact.time > 1)
+        {
+          ball.pos += step;
+          return;
         }
+
+      Contact const &contact = earliest.contact;
+
+      ball.pos += step * contact.time;
+
+      if (contact.normal.x * vel.x < 0)
+        vel.x = -vel.x;
+      if (contact.normal.y * vel.y < 0)
+        vel.y = -vel.y;
+
+      for (size_t j = 0; j < earliest.block_count; j++)
+        {
+          uint32_t const block = earliest.blocks[j];
+
+          // Blocks are drawn by how many hits they have left.
+          mark_dirty (game, block, 1);
+
+          if (--game.blocks.hit_points[block] > 0)
+            continue;
+
+          remove_from_grid (game.grid, get_block (game.blocks, block));
+          kill_block (game.blocks, block);
+        }
+
+      remaining *= 1 - contact.time;
     }
+}
 
-  if (do_intersect (game.ball, game.slab))
+// Equal masses colliding elastically trade their velocities along the
+// axis they touch on, which is the one they overlap least along.
+static void
+bounce_balls (Breakout &game, size_t a, size_t b)
+{
+  AABB const &first = game.balls[a];
+  AABB const &second = game.balls[b];
+  Vec2f &first_vel = game.ball_vels[a];
+  Vec2f &second_vel = game.ball_vels[b];
+
+  Vec2f const overlap =
+    min (first.pos + first.shape, second.pos + second.shape)
+    - max (first.pos, second.pos);
+  // From "second" to "first", doubled.
+  Vec2f const apart =
+    first.pos * 2 + first.shape - second.pos * 2 - second.shape;
+  Vec2f const closing = first_vel - second_vel;
+
+  // Balls already moving apart have been handled on an earlier tick.
+  if (overlap.x < overlap.y)
     {
-      switch (hit_direction (game.slab, game.ball, game.ball_vel))
+      if (closing.x * apart.x < 0)
+        std::swap (first_vel.x, second_vel.x);
+    }
+  else if (closing.y * apart.y < 0)
+    std::swap (first_vel.y, second_vel.y);
+}
+
+// Goes through the ball grid like find_earliest_contact() goes through
+// the block grid, each pair once.
+static void
+collide_balls (Breakout &game)
+{
+  BlockGrid &grid = game.ball_grid;
+
+  fill_block_grid (grid, game.balls, game.ball_count, game.ball_order);
+
+  for (size_t a = 0; a < game.ball_count; a++)
+    {
+      CellRange const range = cells_overlapping (grid, game.balls[a]);
+
+      for (int32_t y = range.y0; y <= range.y1 && range.x0 <= range.x1; y++)
         {
-        case Left:
-        case Right:
-          game.ball_vel.x = -game.ball_vel.x;
-          break;
-        case Down:
-        case Up:
-          game.ball_vel.y = -game.ball_vel.y;
-          break;
+          size_t const row = (size_t)y * grid.columns;
+          size_t const last = grid.cell_first[row + range.x1 + 1];
+
+          for (size_t i = grid.cell_first[row + range.x0]; i < last; i++)
+            {
+              uint32_t const b = game.ball_order[i];
+
+              if (b > a && do_intersect (game.balls[a], game.balls[b]))
+                bounce_balls (game, a, b);
+            }
         }
     }
 }
@@ -151,28 +419,14 @@ resolve_collisions (Breakout &game)
 void
 update (Breakout &game)
 {
-  if (game.ball.pos.x <= -1
-      || game.ball.pos.x + game.ball.shape.x >= 1)
-    game.ball_vel.x = -game.ball_vel.x;
-  else if (game.ball.pos.y <= -1
-           || game.ball.pos.y + game.ball.shape.y >= 1)
-    game.ball_vel.y = -game.ball_vel.y;
-
-  resolve_collisions (game);
-
-  game.ball.pos += game.ball_vel;
-
-  glBindBuffer (GL_ARRAY_BUFFER, game.buffer[1]);
-  glBufferSubData (GL_ARRAY_BUFFER,
-                   Breakout::ball_offset,
-                   sizeof (AABB),
-                   &game.ball);
-}
+  game.prev_slab = game.slab;
+  std::copy (game.balls, game.balls + game.ball_count, game.prev_balls);
 
-void
-draw (const Breakout &game)
-{
-  glBindVertexArray (game.vertex_array);
-  glUseProgram (game.program);
-  glDrawArraysInstanced (GL_TRIANGLE_STRIP, 0, 4, 2 + game.block_count);
+  for (size_t b = 0; b < game.ball_count; b++)
+    move_ball (game, b);
+
+  if (game.ball_count > 1)
+    collide_balls (game);
+
+  game.tick++;
 }
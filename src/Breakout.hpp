@@ -1,36 +1,108 @@
 #ifndef BREAKOUT_HPP
 #define BREAKOUT_HPP
 
-#include "gl_types.hpp"
+#include <cstddef>
+#include <cstdint>
 #include "AABB.hpp"
+#include "Grid.hpp"
+#include "BlockStore.hpp"
+#include "Level.hpp"
+#include "Arena.hpp"
+
+// Blocks by index in the store, or instances. A range is
+// "[first, first + count[".
+struct InstanceRange
+{
+  uint32_t first, count;
+};
+
+// Overlapping and adjacent ranges are merged. When it runs out of slots
+// the list collapses into a single covering range.
+struct DirtyList
+{
+  static size_t constexpr max_ranges = 16;
+
+  InstanceRange ranges[max_ranges];
+  size_t count;
+};
+
+void
+add_range (DirtyList &list, uint32_t first, uint32_t count);
+
+enum Input : uint8_t
+  {
+   Input_Left, Input_Right, Input_SpawnBall
+  };
+
+#define DEFAULT_BALL_CAPACITY 512
 
 struct Breakout
 {
-  AABB *blocks;
-  size_t block_count;
+  BlockStore blocks;
+  BlockGrid grid;
 
   AABB slab;
   Vec2f slab_vel;
 
-  AABB ball;
-  Vec2f ball_vel;
+  // Pool of "ball_capacity" balls, pushed once with the game. The
+  // first "ball_count" are in play.
+  AABB *balls;
+  Vec2f *ball_vels;
+  size_t ball_count, ball_capacity;
+
+  // Balls filed by cell every tick, to find the pairs that touch.
+  BlockGrid ball_grid;
+  uint32_t *ball_order;
+
+  // State before the last update(), for rendering between ticks.
+  AABB prev_slab;
+  AABB *prev_balls;
 
-  gluint vertex_array;
-  gluint buffer[2];
-  gluint program;
+  // The level's "fingerprint", for saved states to check against.
+  uint64_t level_fingerprint;
 
-  static uint32_t constexpr slab_offset = 0;
-  static uint32_t constexpr ball_offset = sizeof (AABB);
-  static uint32_t constexpr block_offset = 2 * sizeof (AABB);
+  // Number of update() calls so far.
+  uint64_t tick;
+  // xorshift64* state. Never zero.
+  uint64_t rng;
+
+  // Blocks, by index in the store, whose hit points changed since the
+  // renderer last consumed them. The slab and balls change all the time
+  // and are not tracked.
+  DirtyList dirty;
 };
 
+// Games created from the same level and seed and fed the same inputs on
+// the same ticks end up in the same state. The game takes over the
+// level's blocks and grid, so a level starts at most one game. The
+// level's ball is the first one in play. Everything else the game needs
+// is pushed onto "arena", usually the level's.
 Breakout
-create_breakout (void);
+create_breakout (Arena &arena,
+                 const Level &level,
+                 uint64_t seed,
+                 size_t ball_capacity = DEFAULT_BALL_CAPACITY);
+
+// False if the pool is full.
+bool
+spawn_ball (Breakout &game, const AABB &ball, const Vec2f &vel);
 
+// Advances the simulation by one fixed tick.
 void
 update (Breakout &game);
 
+// Applies an input before the next update().
+void
+handle_input (Breakout &game, Input input);
+
+uint32_t
+random_u32 (Breakout &game);
+
+// FNV-1a over everything that influences future ticks.
+uint64_t
+hash_state (const Breakout &game);
+
 void
-draw (const Breakout &game);
+mark_dirty (Breakout &game, uint32_t first, uint32_t count);
 
 #endif // BREAKOUT_HPP
@@ -0,0 +1,101 @@
+#include "BreakoutBatch.hpp"
+
+// Games per claim. Small enough to balance, large enough that claiming
+// does not dominate a tick that costs well under a microsecond.
+#define GAMES_PER_GRAIN 64
+
+// Address space reserved per game, far more than the default level and
+// a single ball take.
+#define BYTES_PER_GAME (64 << 10)
+
+struct StepContext
+{
+  BreakoutBatch *batch;
+  const Action *actions;
+  float *observations;
+};
+
+BreakoutBatch
+create_breakout_batch (size_t count, uint64_t seed)
+{
+  BreakoutBatch batch;
+
+  batch.arena = create_arena ((count + 1) * BYTES_PER_GAME);
+  batch.count = count;
+  batch.games = (Breakout *)push (batch.arena, count * sizeof (Breakout));
+
+  Arena scratch = create_arena (BYTES_PER_GAME);
+
+  for (size_t i = 0; i < count; i++)
+    batch.games[i] =
+      create_breakout (batch.arena,
+                       default_level (batch.arena, scratch),
+                       seed + i,
+                       1);
+
+  destroy_arena (scratch);
+
+  return batch;
+}
+
+void
+destroy_breakout_batch (BreakoutBatch &batch)
+{
+  destroy_arena (batch.arena);
+  batch.games = NULL;
+  batch.count = 0;
+}
+
+static void
+step_range (size_t first, size_t last, void *data)
+{
+  StepContext &context = *(StepContext *)data;
+
+  for (size_t i = first; i < last; i++)
+    {
+      Breakout &game = context.batch->games[i];
+
+      if (context.actions != NULL)
+        {
+          switch (context.actions[i])
+            {
+            case Action_None:
+              break;
+            case Action_Left:
+              handle_input (game, Input_Left);
+              break;
+            case Action_Right:
+              handle_input (game, Input_Right);
+              break;
+            }
+        }
+
+      update (game);
+      // Nobody renders batched games.
+      game.dirty.count = 0;
+
+      if (context.observations != NULL)
+        {
+          float *observation =
+            context.observations + i * OBSERVATION_SIZE;
+
+          observation[0] = game.slab.pos.x;
+          observation[1] = game.balls[0].pos.x;
+          observation[2] = game.balls[0].pos.y;
+          observation[3] = game.ball_vels[0].x;
+          observation[4] = game.ball_vels[0].y;
+          observation[5] = game.blocks.live_count;
+        }
+    }
+}
+
+void
+step (BreakoutBatch &batch,
+      ThreadPool &pool,
+      const Action *actions,
+      float *observations)
+{
+  StepContext context = { &batch, actions, observations };
+
+  parallel_for (pool, batch.count, GAMES_PER_GRAIN, step_range, &context);
+}
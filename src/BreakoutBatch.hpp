@@ -0,0 +1,45 @@
+#ifndef BREAKOUT_BATCH_HPP
+#define BREAKOUT_BATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "Arena.hpp"
+#include "Breakout.hpp"
+#include "ThreadPool.hpp"
+
+enum Action : uint8_t
+  {
+   Action_None, Action_Left, Action_Right
+  };
+
+// Per game, in this order: slab x, ball x, ball y, ball velocity x and y,
+// live blocks.
+#define OBSERVATION_SIZE 6
+
+// Many independent games stepped together, all on the default level and
+// with a single ball.
+// Game "i" is seeded with "seed + i", so any one of them can be
+// reproduced on its own. Games and levels all live on "arena".
+struct BreakoutBatch
+{
+  Arena arena;
+  Breakout *games;
+  size_t count;
+};
+
+BreakoutBatch
+create_breakout_batch (size_t count, uint64_t seed);
+
+void
+destroy_breakout_batch (BreakoutBatch &batch);
+
+// Applies "actions[i]" to game "i", advances every game by one tick and
+// writes "OBSERVATION_SIZE" floats per game to "observations". Either
+// pointer may be NULL.
+void
+step (BreakoutBatch &batch,
+      ThreadPool &pool,
+      const Action *actions,
+      float *observations);
+
+#endif // BREAKOUT_BATCH_HPP
@@ -0,0 +1,284 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "FrameDumper.hpp"
+
+FrameDumper
+create_frame_dumper (Arena &arena,
+                     const char *pattern,
+                     uint32_t width,
+                     uint32_t height)
+{
+  FrameDumper dumper;
+  size_t const length = std::strlen (pattern);
+
+  dumper.pattern = pattern;
+  dumper.png = length >= 4 && std::strcmp (pattern + length - 4, ".png") == 0;
+  dumper.width = width;
+  dumper.height = height;
+  dumper.next = 0;
+  dumper.frame_count = 0;
+  dumper.image = (uint8_t *)push (arena, (size_t)height * (1 + 3 * width));
+
+  for (auto &frame : dumper.frames)
+    {
+      gluint buffer;
+      glCreateBuffers (1, &buffer);
+      glNamedBufferData (buffer,
+                         (size_t)width * height * 4,
+                         NULL,
+                         GL_STREAM_READ);
+      frame.pixels = GlBuffer (buffer);
+    }
+
+  return dumper;
+}
+
+static uint32_t crc_table[256];
+
+static uint32_t
+update_crc (uint32_t crc, const uint8_t *data, size_t size)
+{
+  if (crc_table[1] == 0)
+    for (uint32_t n = 0; n < 256; n++)
+      {
+        uint32_t c = n;
+
+        for (int k = 0; k < 8; k++)
+          c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+
+        crc_table[n] = c;
+      }
+
+  for (size_t i = 0; i < size; i++)
+    crc = crc_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+
+  return crc;
+}
+
+static void
+put_u32_be (uint8_t *out, uint32_t value)
+{
+  out[0] = value >> 24;
+  out[1] = value >> 16;
+  out[2] = value >> 8;
+  out[3] = value;
+}
+
+// A chunk is written in pieces; "crc" runs over its type and data.
+struct PngChunk
+{
+  FILE *file;
+  uint32_t crc;
+};
+
+static PngChunk
+begin_chunk (FILE *file, const char *type, uint32_t length)
+{
+  uint8_t header[8];
+
+  put_u32_be (header, length);
+  std::memcpy (header + 4, type, 4);
+  std::fwrite (header, 1, 8, file);
+
+  return { file, update_crc (0xffffffff, header + 4, 4) };
+}
+
+static void
+chunk_data (PngChunk &chunk, const void *data, size_t size)
+{
+  std::fwrite (data, 1, size, chunk.file);
+  chunk.crc = update_crc (chunk.crc, (const uint8_t *)data, size);
+}
+
+static void
+end_chunk (PngChunk &chunk)
+{
+  uint8_t crc[4];
+
+  put_u32_be (crc, chunk.crc ^ 0xffffffff);
+  std::fwrite (crc, 1, 4, chunk.file);
+}
+
+static uint32_t
+adler32 (const uint8_t *data, size_t size)
+{
+  uint32_t a = 1, b = 0;
+
+  // 5552 is the most bytes that cannot overflow "b" before the modulo.
+  while (size > 0)
+    {
+      size_t const run = size < 5552 ? size : 5552;
+
+      for (size_t i = 0; i < run; i++)
+        {
+          a += data[i];
+          b += a;
+        }
+
+      a %= 65521;
+      b %= 65521;
+      data += run;
+      size -= run;
+    }
+
+  return b << 16 | a;
+}
+
+// Truecolor, 8 bits per channel. The image is stored rather than
+// compressed: one IDAT chunk per stored deflate block, the zlib header
+// in the first and the checksum in the last. Bigger files, but writing
+// them costs about as much as a PPM.
+static void
+write_png (FILE *file, const uint8_t *image, uint32_t width, uint32_t height)
+{
+  static uint8_t const signature[8] =
+    { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+  size_t const size = (size_t)height * (1 + 3 * width);
+  uint32_t const checksum = adler32 (image, size);
+
+  std::fwrite (signature, 1, 8, file);
+
+  {
+    uint8_t header[13] = { 0 };
+
+    put_u32_be (header, width);
+    put_u32_be (header + 4, height);
+    header[8] = 8;
+    header[9] = 2;
+
+    PngChunk chunk = begin_chunk (file, "IHDR", sizeof (header));
+    chunk_data (chunk, header, sizeof (header));
+    end_chunk (chunk);
+  }
+
+  for (size_t offset = 0; offset < size; )
+    {
+      size_t const block = size - offset < 65535 ? size - offset : 65535;
+      bool const first = offset == 0;
+      bool const last = offset + block == size;
+      uint8_t const zlib_header[2] = { 0x78, 0x01 };
+      uint8_t const block_header[5] =
+        { (uint8_t)last,
+          (uint8_t)block, (uint8_t)(block >> 8),
+          (uint8_t)~block, (uint8_t)(~block >> 8) };
+      uint8_t trailer[4];
+
+      put_u32_be (trailer, checksum);
+
+      PngChunk chunk =
+        begin_chunk (file,
+                     "IDAT",
+                     (first ? 2 : 0) + 5 + block + (last ? 4 : 0));
+
+      if (first)
+        chunk_data (chunk, zlib_header, 2);
+
+      chunk_data (chunk, block_header, 5);
+      chunk_data (chunk, image + offset, block);
+
+      if (last)
+        chunk_data (chunk, trailer, 4);
+
+      end_chunk (chunk);
+      offset += block;
+    }
+
+  PngChunk chunk = begin_chunk (file, "IEND", 0);
+  end_chunk (chunk);
+}
+
+static void
+write_frame (FrameDumper &dumper, PendingFrame &frame)
+{
+  glClientWaitSync (frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
+  frame.fence.reset ();
+
+  uint32_t const width = dumper.width, height = dumper.height;
+  size_t const row_size = (dumper.png ? 1 : 0) + 3 * (size_t)width;
+  const uint8_t *pixels =
+    (const uint8_t *)glMapNamedBufferRange (frame.pixels,
+                                            0,
+                                            (size_t)width * height * 4,
+                                            GL_MAP_READ_BIT);
+
+  // GL counts rows from the bottom, both formats from the top.
+  for (uint32_t y = 0; y < height; y++)
+    {
+      const uint8_t *in = pixels + (size_t)(height - 1 - y) * width * 4;
+      uint8_t *out = dumper.image + y * row_size;
+
+      if (dumper.png)
+        *out++ = 0;
+
+      for (uint32_t x = 0; x < width; x++, in += 4, out += 3)
+        {
+          out[0] = in[0];
+          out[1] = in[1];
+          out[2] = in[2];
+        }
+    }
+
+  glUnmapNamedBuffer (frame.pixels);
+
+  char path[4096];
+  std::snprintf (path, sizeof (path), dumper.pattern, (int)frame.index);
+
+  FILE *file = std::fopen (path, "wb");
+
+  if (file == NULL)
+    {
+      std::fprintf (stderr, "ERROR: failed to open file \'%s\'.\n", path);
+      std::exit (EXIT_FAILURE);
+    }
+
+  if (dumper.png)
+    write_png (file, dumper.image, width, height);
+  else
+    {
+      std::fprintf (file, "P6\n%u %u\n255\n", width, height);
+      std::fwrite (dumper.image, row_size, height, file);
+    }
+
+  if (std::fclose (file) != 0)
+    {
+      std::fprintf (stderr, "ERROR: failed to write file \'%s\'.\n", path);
+      std::exit (EXIT_FAILURE);
+    }
+}
+
+void
+capture_frame (FrameDumper &dumper)
+{
+  PendingFrame &frame = dumper.frames[dumper.next];
+
+  if (frame.fence != 0)
+    write_frame (dumper, frame);
+
+  glBindBuffer (GL_PIXEL_PACK_BUFFER, frame.pixels);
+  glReadPixels (0,
+                0,
+                dumper.width,
+                dumper.height,
+                GL_RGBA,
+                GL_UNSIGNED_BYTE,
+                (void *)0);
+  glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+
+  frame.fence = GlSync (glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+  frame.index = dumper.frame_count++;
+  dumper.next = (dumper.next + 1) % DUMP_BUFFERS;
+}
+
+void
+finish_frame_dumper (FrameDumper &dumper)
+{
+  // Oldest first, so files appear in order.
+  for (size_t i = 0; i < DUMP_BUFFERS; i++)
+    {
+      PendingFrame &frame = dumper.frames[(dumper.next + i) % DUMP_BUFFERS];
+
+      if (frame.fence != 0)
+        write_frame (dumper, frame);
+    }
+}
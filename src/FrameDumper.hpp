@@ -0,0 +1,58 @@
+#ifndef FRAME_DUMPER_HPP
+#define FRAME_DUMPER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "gl_types.hpp"
+#include "GlObject.hpp"
+#include "Arena.hpp"
+
+// Frames being read back at once. A frame is written out once this many
+// later frames were captured, by when the GPU is long done with it.
+#define DUMP_BUFFERS 3
+
+struct PendingFrame
+{
+  GlBuffer pixels;
+  GlSync fence;
+  uint64_t index;
+};
+
+// Writes the frames of the bound read framebuffer to numbered files.
+// Pixels are copied into pixel buffer objects without waiting for the
+// GPU and only mapped DUMP_BUFFERS frames later, so capturing does not
+// stall the pipeline.
+//
+// "pattern" is a printf format taking the frame number as an int, like
+// "frames/%05d.png". Frames are PNG if it ends in ".png", binary PPM
+// otherwise.
+struct FrameDumper
+{
+  const char *pattern;
+  bool png;
+  uint32_t width, height;
+
+  PendingFrame frames[DUMP_BUFFERS];
+  size_t next;
+  uint64_t frame_count;
+
+  // Flipped rows, each behind a PNG filter byte when writing PNG.
+  uint8_t *image;
+};
+
+FrameDumper
+create_frame_dumper (Arena &arena,
+                     const char *pattern,
+                     uint32_t width,
+                     uint32_t height);
+
+// Starts reading back the current frame, and writes the oldest one
+// still pending if that needs its buffer.
+void
+capture_frame (FrameDumper &dumper);
+
+// Writes every frame still pending.
+void
+finish_frame_dumper (FrameDumper &dumper);
+
+#endif // FRAME_DUMPER_HPP
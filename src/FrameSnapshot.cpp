@@ -0,0 +1,155 @@
+#include <cstring>
+#include <new>
+#include "Timing.hpp"
+#include "FrameSnapshot.hpp"
+
+SnapshotBuffer *
+create_snapshot_buffer (Arena &arena, const Breakout &game)
+{
+  SnapshotBuffer *buffer =
+    new (push (arena, sizeof (SnapshotBuffer))) SnapshotBuffer ();
+
+  size_t const alive_words = (game.blocks.count + 31) / 32;
+
+  buffer->block_count = game.blocks.count;
+  buffer->ball_capacity = game.ball_capacity;
+
+  for (auto &slot : buffer->slots)
+    {
+      slot.balls = (AABB *)push (arena, game.ball_capacity * sizeof (AABB));
+      slot.prev_balls =
+        (AABB *)push (arena, game.ball_capacity * sizeof (AABB));
+      slot.blocks =
+        (Instance *)push (arena, game.blocks.count * sizeof (Instance));
+      slot.alive = (uint32_t *)push (arena, alive_words * sizeof (uint32_t));
+      slot.block_count = game.blocks.count;
+    }
+
+  buffer->back = 0;
+  buffer->middle.store (1, std::memory_order_relaxed);
+  buffer->front = 2;
+
+  return buffer;
+}
+
+void
+note_input (SnapshotBuffer &buffer, uint64_t read_time, uint64_t tick)
+{
+  if (buffer.unread_input_count == SNAPSHOT_MAX_INPUTS)
+    return;
+
+  buffer.unread_inputs[buffer.unread_input_count++] =
+    { read_time, now_ns (), tick };
+}
+
+// Brings the blocks of "slot" up to date with "game".
+static void
+refresh_blocks (FrameSnapshot &slot, DirtyList &stale, const Breakout &game)
+{
+  BlockStore const &blocks = game.blocks;
+
+  for (size_t i = 0; i < stale.count; i++)
+    {
+      uint32_t const first = stale.ranges[i].first;
+      uint32_t const last = first + stale.ranges[i].count;
+
+      for (uint32_t j = first; j < last; j++)
+        slot.blocks[j] =
+          pack_instance (get_block (blocks, j),
+                         BLOCK_COLOR,
+                         is_alive (blocks, j) ? blocks.hit_points[j] : 0);
+
+      std::memcpy (slot.alive + first / 32,
+                   blocks.alive + first / 32,
+                   ((last + 31) / 32 - first / 32) * sizeof (uint32_t));
+    }
+
+  stale.count = 0;
+}
+
+void
+publish (SnapshotBuffer &buffer, Breakout &game, uint64_t time)
+{
+  // Without the fresh bit the renderer took the last snapshot, and with
+  // it everything published until then. Over-reporting when it does so
+  // right after this check is harmless: "acquire" drops inputs the
+  // renderer already saw, and instances it gets again are only
+  // uploaded twice.
+  if (!(buffer.middle.load (std::memory_order_acquire) & SNAPSHOT_FRESH))
+    {
+      size_t const published = buffer.published_input_count;
+
+      buffer.unread.count = 0;
+      buffer.unread_input_count -= published;
+      std::memmove (buffer.unread_inputs,
+                    buffer.unread_inputs + published,
+                    buffer.unread_input_count * sizeof (AppliedInput));
+    }
+
+  for (size_t i = 0; i < game.dirty.count; i++)
+    {
+      InstanceRange const range = game.dirty.ranges[i];
+
+      for (auto &stale : buffer.stale)
+        add_range (stale, range.first, range.count);
+
+      add_range (buffer.unread, range.first, range.count);
+    }
+
+  game.dirty.count = 0;
+
+  FrameSnapshot &slot = buffer.slots[buffer.back];
+
+  refresh_blocks (slot, buffer.stale[buffer.back], game);
+
+  slot.tick = game.tick;
+  slot.time = time;
+  slot.slab = game.slab;
+  slot.prev_slab = game.prev_slab;
+  slot.ball_count = game.ball_count;
+  std::memcpy (slot.balls, game.balls, game.ball_count * sizeof (AABB));
+  std::memcpy (slot.prev_balls,
+               game.prev_balls,
+               game.ball_count * sizeof (AABB));
+
+  slot.changed = buffer.unread;
+  slot.input_count = buffer.unread_input_count;
+  std::memcpy (slot.inputs,
+               buffer.unread_inputs,
+               buffer.unread_input_count * sizeof (AppliedInput));
+  buffer.published_input_count = buffer.unread_input_count;
+
+  uint32_t const previous =
+    buffer.middle.exchange (buffer.back | SNAPSHOT_FRESH,
+                            std::memory_order_acq_rel);
+
+  buffer.back = previous & ~SNAPSHOT_FRESH;
+}
+
+FrameSnapshot &
+acquire (SnapshotBuffer &buffer, bool &is_new)
+{
+  is_new =
+    buffer.middle.load (std::memory_order_relaxed) & SNAPSHOT_FRESH;
+
+  if (!is_new)
+    return buffer.slots[buffer.front];
+
+  uint64_t const shown_tick = buffer.slots[buffer.front].tick;
+  uint32_t const previous =
+    buffer.middle.exchange (buffer.front, std::memory_order_acq_rel);
+
+  buffer.front = previous & ~SNAPSHOT_FRESH;
+
+  FrameSnapshot &snapshot = buffer.slots[buffer.front];
+  size_t kept = 0;
+
+  // Inputs before "shown_tick" were in the previous snapshot already.
+  for (size_t i = 0; i < snapshot.input_count; i++)
+    if (snapshot.inputs[i].tick >= shown_tick)
+      snapshot.inputs[kept++] = snapshot.inputs[i];
+
+  snapshot.input_count = kept;
+
+  return snapshot;
+}
@@ -0,0 +1,105 @@
+#ifndef FRAME_SNAPSHOT_HPP
+#define FRAME_SNAPSHOT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "AABB.hpp"
+#include "Arena.hpp"
+#include "Breakout.hpp"
+#include "Instance.hpp"
+
+// Inputs carried per snapshot, the rest of a burst is not reported.
+#define SNAPSHOT_MAX_INPUTS 8
+
+// An input read at "read_time" and applied by tick "tick" at
+// "applied_time".
+struct AppliedInput
+{
+  uint64_t read_time;
+  uint64_t applied_time;
+  uint64_t tick;
+};
+
+// What the renderer needs of the game after "tick" ticks, simulated up to
+// the real time "time". Once published it is not written to until the
+// renderer hands it back.
+struct FrameSnapshot
+{
+  uint64_t tick;
+  uint64_t time;
+
+  AABB slab, prev_slab;
+  AABB *balls, *prev_balls;
+  uint32_t ball_count;
+
+  // Every block in store order, packed for drawing, with the bits of
+  // "BlockStore::alive". Dead blocks have a zero state. Always complete.
+  Instance *blocks;
+  uint32_t *alive;
+  uint32_t block_count;
+
+  // Blocks that differ from the last snapshot the renderer took, and the
+  // inputs applied since.
+  DirtyList changed;
+  AppliedInput inputs[SNAPSHOT_MAX_INPUTS];
+  size_t input_count;
+};
+
+#define SNAPSHOT_SLOTS 3
+
+// Lock-free triple buffer between the simulation, which publishes a
+// snapshot per frame, and the renderer, which takes the newest one. Each
+// side owns one slot, the third is the last one published. Neither side
+// ever waits for the other, a snapshot the renderer did not get to in
+// time is simply replaced.
+//
+// Slots are kept up to date incrementally: "stale" holds per slot the
+// blocks changed since it was last written, and "unread" what
+// changed since the renderer last took a snapshot, so that the one it
+// takes next tells it everything it missed.
+struct SnapshotBuffer
+{
+  FrameSnapshot slots[SNAPSHOT_SLOTS];
+  uint32_t block_count;
+  uint32_t ball_capacity;
+
+  // Simulation side.
+  uint32_t back;
+  DirtyList stale[SNAPSHOT_SLOTS];
+  DirtyList unread;
+  AppliedInput unread_inputs[SNAPSHOT_MAX_INPUTS];
+  size_t unread_input_count;
+  // Leading "unread_inputs" that went out with the last snapshot.
+  size_t published_input_count;
+
+  // Slot last published, with "SNAPSHOT_FRESH" set until the renderer
+  // takes it.
+  alignas (64) std::atomic<uint32_t> middle;
+
+  // Renderer side.
+  alignas (64) uint32_t front;
+};
+
+#define SNAPSHOT_FRESH 4u
+
+// Sized for "game", on "arena". The renderer sees an empty frame until
+// the first "publish".
+SnapshotBuffer *
+create_snapshot_buffer (Arena &arena, const Breakout &game);
+
+// Call when tick "tick" applies an input read at "read_time".
+void
+note_input (SnapshotBuffer &buffer, uint64_t read_time, uint64_t tick);
+
+// Copies the state of "game" into the back slot and publishes it. Clears
+// the dirty list of "game".
+void
+publish (SnapshotBuffer &buffer, Breakout &game, uint64_t time);
+
+// The newest snapshot published. "is_new" tells whether it changed since
+// the last call; if not, its "changed" and "inputs" were already seen.
+FrameSnapshot &
+acquire (SnapshotBuffer &buffer, bool &is_new);
+
+#endif // FRAME_SNAPSHOT_HPP
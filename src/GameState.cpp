@@ -0,0 +1,141 @@
+#include <cstring>
+#include "Utils.hpp"
+#include "GameState.hpp"
+
+// Positions come first in the store, everything from "alive" on changes
+// as blocks are hit.
+static size_t
+changing_store_size (const BlockStore &blocks)
+{
+  return block_store_size (blocks.count)
+    - ((const char *)blocks.alive - (const char *)blocks.min_x);
+}
+
+// Offsets into a state holding "ball_count" balls.
+struct GameStateLayout
+{
+  size_t store, row_live, balls, prev_balls, ball_vels, size;
+};
+
+static GameStateLayout
+layout (const Breakout &game, size_t ball_count)
+{
+  GameStateLayout at;
+
+  at.store = align8 (sizeof (GameStateHeader));
+  at.row_live = align8 (at.store + changing_store_size (game.blocks));
+  at.balls = align8 (at.row_live + game.grid.rows * sizeof (uint32_t));
+  at.prev_balls = at.balls + ball_count * sizeof (AABB);
+  at.ball_vels = at.prev_balls + ball_count * sizeof (AABB);
+  at.size = at.ball_vels + ball_count * sizeof (Vec2f);
+
+  return at;
+}
+
+size_t
+game_state_size (const Breakout &game)
+{
+  return layout (game, game.ball_capacity).size;
+}
+
+size_t
+save_game_state (const Breakout &game, void *memory)
+{
+  GameStateLayout const at = layout (game, game.ball_count);
+  char *const state = (char *)memory;
+  GameStateHeader header;
+
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, GAME_STATE_MAGIC, 4);
+  header.version = GAME_STATE_VERSION;
+  header.byte_order = BYTE_ORDER_MARK;
+  header.block_count = game.blocks.count;
+  header.columns = game.grid.columns;
+  header.rows = game.grid.rows;
+  header.level_fingerprint = game.level_fingerprint;
+  header.live_count = game.blocks.live_count;
+  header.ball_count = game.ball_count;
+  header.tick = game.tick;
+  header.rng = game.rng;
+  header.slab = game.slab;
+  header.prev_slab = game.prev_slab;
+  header.slab_vel = game.slab_vel;
+  header.size = at.size;
+
+  std::memcpy (state, &header, sizeof (header));
+  std::memcpy (state + at.store,
+               game.blocks.alive,
+               changing_store_size (game.blocks));
+  std::memcpy (state + at.row_live,
+               game.grid.row_live,
+               game.grid.rows * sizeof (uint32_t));
+  std::memcpy (state + at.balls,
+               game.balls,
+               game.ball_count * sizeof (AABB));
+  std::memcpy (state + at.prev_balls,
+               game.prev_balls,
+               game.ball_count * sizeof (AABB));
+  std::memcpy (state + at.ball_vels,
+               game.ball_vels,
+               game.ball_count * sizeof (Vec2f));
+
+  return at.size;
+}
+
+bool
+restore_game_state (Breakout &game, const void *memory, size_t size)
+{
+  const char *const state = (const char *)memory;
+  GameStateHeader header;
+
+  if (size < sizeof (header))
+    return false;
+
+  std::memcpy (&header, state, sizeof (header));
+
+  if (std::memcmp (header.magic, GAME_STATE_MAGIC, 4) != 0
+      || header.version != GAME_STATE_VERSION
+      || header.byte_order != BYTE_ORDER_MARK
+      || header.block_count != game.blocks.count
+      || header.columns != game.grid.columns
+      || header.rows != game.grid.rows
+      || header.level_fingerprint != game.level_fingerprint
+      || header.live_count > header.block_count
+      || header.ball_count > game.ball_capacity)
+    return false;
+
+  GameStateLayout const at = layout (game, header.ball_count);
+
+  if (header.size != at.size || size < at.size)
+    return false;
+
+  std::memcpy (game.blocks.alive,
+               state + at.store,
+               changing_store_size (game.blocks));
+  std::memcpy (game.grid.row_live,
+               state + at.row_live,
+               game.grid.rows * sizeof (uint32_t));
+  std::memcpy (game.balls,
+               state + at.balls,
+               header.ball_count * sizeof (AABB));
+  std::memcpy (game.prev_balls,
+               state + at.prev_balls,
+               header.ball_count * sizeof (AABB));
+  std::memcpy (game.ball_vels,
+               state + at.ball_vels,
+               header.ball_count * sizeof (Vec2f));
+
+  game.blocks.live_count = header.live_count;
+  game.ball_count = header.ball_count;
+  game.tick = header.tick;
+  game.rng = header.rng;
+  game.slab = header.slab;
+  game.prev_slab = header.prev_slab;
+  game.slab_vel = header.slab_vel;
+
+  // One range over everything, which the renderer uploads at once.
+  game.dirty.count = 0;
+  mark_dirty (game, 0, game.blocks.count);
+
+  return true;
+}
@@ -0,0 +1,53 @@
+#ifndef GAME_STATE_HPP
+#define GAME_STATE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "Breakout.hpp"
+
+// A saved game is a "GameStateHeader" followed by what play changes, as
+// it sits in memory: the block store from "alive" on, the grid's live
+// counts per row and the balls in play. Block positions and grid cells
+// are the level's and never change, so they are not saved, only the
+// level's fingerprint is, and a state only restores into a game started
+// from the level it was saved from.
+// Like binary levels, states are native-endian and for the build that
+// wrote them.
+#define GAME_STATE_MAGIC "BKGS"
+#define GAME_STATE_VERSION 2
+
+struct GameStateHeader
+{
+  char magic[4];
+  uint32_t version;
+  // Written as 0x01020304, to reject states from other byte orders.
+  uint32_t byte_order;
+  uint32_t block_count;
+  int32_t columns, rows;
+  uint64_t level_fingerprint;
+  uint64_t live_count;
+  uint64_t ball_count;
+  uint64_t tick, rng;
+  AABB slab, prev_slab;
+  Vec2f slab_vel;
+  // Of the whole state, header included.
+  uint64_t size;
+};
+
+// Most bytes a state of "game" can take, however many balls are in
+// play.
+size_t
+game_state_size (const Breakout &game);
+
+// Writes the state of "game" to "memory", which has room for
+// "game_state_size", and returns its size.
+size_t
+save_game_state (const Breakout &game, void *memory);
+
+// False, leaving "game" as it was, if "memory" does not hold a state of
+// this game's level. All blocks are marked dirty, so the renderer
+// replaces them in one upload.
+bool
+restore_game_state (Breakout &game, const void *memory, size_t size);
+
+#endif // GAME_STATE_HPP
@@ -0,0 +1,74 @@
+#ifndef GL_OBJECT_HPP
+#define GL_OBJECT_HPP
+
+#include "gl_types.hpp"
+
+// Owns one GL object and deletes it on destruction. Moves hand the
+// object over, copies are not allowed. The null handle owns nothing.
+template <typename Handle, void (*destroy) (Handle)>
+struct GlObject
+{
+  Handle handle;
+
+  GlObject () : handle (0) { }
+  explicit GlObject (Handle handle) : handle (handle) { }
+  GlObject (GlObject &&other) : handle (other.release ()) { }
+  ~GlObject () { reset (); }
+
+  GlObject &
+  operator= (GlObject &&other)
+  {
+    if (this != &other)
+      {
+        reset ();
+        handle = other.release ();
+      }
+
+    return *this;
+  }
+
+  GlObject (const GlObject &) = delete;
+  GlObject &operator= (const GlObject &) = delete;
+
+  operator Handle () const { return handle; }
+
+  Handle
+  release ()
+  {
+    Handle const released = handle;
+    handle = 0;
+
+    return released;
+  }
+
+  void
+  reset ()
+  {
+    if (handle != 0)
+      destroy (handle);
+
+    handle = 0;
+  }
+};
+
+// GLEW loads the entry points at run time, so they cannot be template
+// arguments themselves.
+inline void delete_buffer (gluint id) { glDeleteBuffers (1, &id); }
+inline void delete_vertex_array (gluint id) { glDeleteVertexArrays (1, &id); }
+inline void delete_shader (gluint id) { glDeleteShader (id); }
+inline void delete_program (gluint id) { glDeleteProgram (id); }
+inline void delete_query (gluint id) { glDeleteQueries (1, &id); }
+inline void delete_sync (glsync sync) { glDeleteSync (sync); }
+inline void delete_framebuffer (gluint id) { glDeleteFramebuffers (1, &id); }
+inline void delete_renderbuffer (gluint id) { glDeleteRenderbuffers (1, &id); }
+
+typedef GlObject<gluint, delete_buffer> GlBuffer;
+typedef GlObject<gluint, delete_vertex_array> GlVertexArray;
+typedef GlObject<gluint, delete_shader> GlShader;
+typedef GlObject<gluint, delete_program> GlProgram;
+typedef GlObject<gluint, delete_query> GlQuery;
+typedef GlObject<glsync, delete_sync> GlSync;
+typedef GlObject<gluint, delete_framebuffer> GlFramebuffer;
+typedef GlObject<gluint, delete_renderbuffer> GlRenderbuffer;
+
+#endif // GL_OBJECT_HPP
@@ -0,0 +1,137 @@
+#include <cmath>
+#include <algorithm>
+#include "Grid.hpp"
+
+static int32_t
+cell_x (const BlockGrid &grid, float x)
+{
+  return (int32_t)std::floor ((x - grid.origin.x) / grid.cell_size.x);
+}
+
+static int32_t
+cell_y (const BlockGrid &grid, float y)
+{
+  return (int32_t)std::floor ((y - grid.origin.y) / grid.cell_size.y);
+}
+
+static uint32_t
+cell_of (const BlockGrid &grid, const AABB &block)
+{
+  int32_t const x = std::min (std::max (cell_x (grid, block.pos.x), 0),
+                              grid.columns - 1);
+  int32_t const y = std::min (std::max (cell_y (grid, block.pos.y), 0),
+                              grid.rows - 1);
+
+  return y * grid.columns + x;
+}
+
+size_t
+block_grid_size (const BlockGrid &grid)
+{
+  return ((size_t)grid.columns * grid.rows + 1 + grid.rows)
+    * sizeof (uint32_t);
+}
+
+void
+place_block_grid (BlockGrid &grid, void *memory)
+{
+  grid.cell_first = (uint32_t *)memory;
+  grid.row_live = grid.cell_first + (size_t)grid.columns * grid.rows + 1;
+}
+
+void
+fill_block_grid (BlockGrid &grid,
+                 const AABB *blocks,
+                 size_t block_count,
+                 uint32_t *order)
+{
+  size_t const cell_count = (size_t)grid.columns * grid.rows;
+
+  // Counting sort by cell: count, prefix sum, scatter.
+  std::fill (grid.cell_first, grid.cell_first + cell_count + 1, 0);
+
+  for (size_t i = 0; i < block_count; i++)
+    grid.cell_first[cell_of (grid, blocks[i]) + 1]++;
+
+  for (size_t c = 0; c < cell_count; c++)
+    grid.cell_first[c + 1] += grid.cell_first[c];
+
+  for (size_t i = 0; i < block_count; i++)
+    order[grid.cell_first[cell_of (grid, blocks[i])]++] = i;
+
+  // Scattering advanced every cell to the start of the next one.
+  for (size_t c = cell_count; c > 0; c--)
+    grid.cell_first[c] = grid.cell_first[c - 1];
+
+  grid.cell_first[0] = 0;
+
+  for (int32_t y = 0; y < grid.rows; y++)
+    grid.row_live[y] = (grid.cell_first[(y + 1) * grid.columns]
+                        - grid.cell_first[y * grid.columns]);
+}
+
+BlockGrid
+create_block_grid (Arena &arena,
+                   const AABB *blocks,
+                   size_t block_count,
+                   uint32_t *order)
+{
+  BlockGrid grid;
+
+  Vec2f min = { 0, 0 }, max = { 0, 0 }, largest = { 0, 0 };
+
+  for (size_t i = 0; i < block_count; i++)
+    {
+      AABB const &block = blocks[i];
+
+      if (i == 0)
+        min = max = block.pos;
+
+      min.x = std::min (min.x, block.pos.x);
+      min.y = std::min (min.y, block.pos.y);
+      max.x = std::max (max.x, block.pos.x + block.shape.x);
+      max.y = std::max (max.y, block.pos.y + block.shape.y);
+      largest.x = std::max (largest.x, block.shape.x);
+      largest.y = std::max (largest.y, block.shape.y);
+    }
+
+  // Degenerate levels (no blocks, zero sized blocks) still get a grid
+  // with at least one cell of non-zero size.
+  float const min_cell_size = 1.0f / 1024;
+
+  grid.origin = min;
+  grid.cell_size = { std::max (largest.x, min_cell_size),
+                     std::max (largest.y, min_cell_size) };
+  grid.columns =
+    std::max ((int32_t)std::ceil ((max.x - min.x) / grid.cell_size.x), 1);
+  grid.rows =
+    std::max ((int32_t)std::ceil ((max.y - min.y) / grid.cell_size.y), 1);
+
+  place_block_grid (grid, push (arena, block_grid_size (grid)));
+  fill_block_grid (grid, blocks, block_count, order);
+
+  return grid;
+}
+
+void
+remove_from_grid (BlockGrid &grid, const AABB &block)
+{
+  grid.row_live[cell_of (grid, block) / grid.columns]--;
+}
+
+CellRange
+cells_overlapping (const BlockGrid &grid, const AABB &area)
+{
+  CellRange range =
+    { cell_x (grid, area.pos.x - grid.cell_size.x),
+      cell_y (grid, area.pos.y - grid.cell_size.y),
+      cell_x (grid, area.pos.x + area.shape.x),
+      cell_y (grid, area.pos.y + area.shape.y) };
+
+  range.x0 = std::max (range.x0, 0);
+  range.y0 = std::max (range.y0, 0);
+  range.x1 = std::min (range.x1, grid.columns - 1);
+  range.y1 = std::min (range.y1, grid.rows - 1);
+
+  return range;
+}
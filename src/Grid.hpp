@@ -0,0 +1,65 @@
+#ifndef GRID_HPP
+#define GRID_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "AABB.hpp"
+#include "Arena.hpp"
+
+// Uniform grid over the blocks. Each block is filed under the cell that
+// holds its "pos" corner only, and cells are at least as large as the
+// largest block, so a block can only reach into the cells right and
+// above its own.
+//
+// The block store is kept sorted by cell, row by row: cell "c" holds
+// blocks "[cell_first[c], cell_first[c + 1][", and a run of cells within
+// one row is a single contiguous range of blocks.
+struct BlockGrid
+{
+  Vec2f origin;
+  Vec2f cell_size;
+  int32_t columns, rows;
+
+  uint32_t *cell_first;
+  // Live blocks per row, so that cleared rows are skipped entirely.
+  uint32_t *row_live;
+};
+
+// Inclusive range of cells.
+struct CellRange
+{
+  int32_t x0, y0, x1, y1;
+};
+
+size_t
+block_grid_size (const BlockGrid &grid);
+
+// Points the arrays of "grid", whose dimensions are already set, into
+// "memory", which already holds their contents.
+void
+place_block_grid (BlockGrid &grid, void *memory);
+
+// Files "blocks" into "grid", whose dimensions and arrays are already set,
+// writing to "order" the indices of "blocks" sorted by cell.
+void
+fill_block_grid (BlockGrid &grid,
+                 const AABB *blocks,
+                 size_t block_count,
+                 uint32_t *order);
+
+// Writes to "order" the indices of "blocks" in the order the block store
+// has to hold them.
+BlockGrid
+create_block_grid (Arena &arena,
+                   const AABB *blocks,
+                   size_t block_count,
+                   uint32_t *order);
+
+void
+remove_from_grid (BlockGrid &grid, const AABB &block);
+
+// Cells whose blocks may overlap "area". Empty if "x0 > x1" or "y0 > y1".
+CellRange
+cells_overlapping (const BlockGrid &grid, const AABB &area);
+
+#endif // GRID_HPP
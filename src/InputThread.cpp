@@ -0,0 +1,136 @@
+#include <cstdio>
+#include <cstdlib>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <X11/XKBlib.h>
+#include "Timing.hpp"
+#include "InputThread.hpp"
+
+static_assert ((KEY_QUEUE_CAPACITY & (KEY_QUEUE_CAPACITY - 1)) == 0,
+               "the queue indexes with a mask");
+
+bool
+push (KeyQueue &queue, const KeyEvent &event)
+{
+  uint32_t const tail = queue.tail.load (std::memory_order_relaxed);
+
+  if (tail - queue.head.load (std::memory_order_acquire)
+      == KEY_QUEUE_CAPACITY)
+    return false;
+
+  queue.events[tail % KEY_QUEUE_CAPACITY] = event;
+  queue.tail.store (tail + 1, std::memory_order_release);
+
+  return true;
+}
+
+const KeyEvent *
+peek (KeyQueue &queue)
+{
+  uint32_t const head = queue.head.load (std::memory_order_relaxed);
+
+  if (head == queue.tail.load (std::memory_order_acquire))
+    return NULL;
+
+  return &queue.events[head % KEY_QUEUE_CAPACITY];
+}
+
+void
+pop (KeyQueue &queue)
+{
+  uint32_t const head = queue.head.load (std::memory_order_relaxed);
+
+  queue.head.store (head + 1, std::memory_order_release);
+}
+
+static void
+read_input (InputThread &input)
+{
+  Display *const display = input.display;
+  pollfd fds[2] = { { ConnectionNumber (display), POLLIN, 0 },
+                    { input.wake_fd, POLLIN, 0 } };
+  // By keycode, as far as the consumer was told. Detectable auto-repeat
+  // only drops the fake releases, a held key still sends a press at the
+  // repeat rate, which is dropped here.
+  bool is_down[256] = { false };
+
+  for (;;)
+    {
+      while (XPending (display) > 0)
+        {
+          XEvent xevent;
+          XNextEvent (display, &xevent);
+
+          if (xevent.type != KeyPress && xevent.type != KeyRelease)
+            continue;
+
+          unsigned const keycode = xevent.xkey.keycode & 0xff;
+          bool const is_press = xevent.type == KeyPress;
+
+          if (is_press == is_down[keycode])
+            continue;
+
+          KeyEvent const event =
+            { now_ns (), XLookupKeysym (&xevent.xkey, 0), is_press };
+
+          // Only a burst of hundreds of keys between two ticks fills the
+          // queue, dropping some of them is fine then. A key whose change
+          // was dropped keeps its old state on both sides.
+          if (push (input.queue, event))
+            is_down[keycode] = is_press;
+        }
+
+      if (poll (fds, 2, -1) == -1)
+        continue;
+
+      if (fds[1].revents != 0)
+        return;
+    }
+}
+
+InputThread *
+start_input_thread (const X11Window &window)
+{
+  InputThread *input = new InputThread;
+
+  input->queue.head.store (0, std::memory_order_relaxed);
+  input->queue.tail.store (0, std::memory_order_relaxed);
+  input->display = XOpenDisplay (DisplayString (window.display));
+  input->wake_fd = eventfd (0, EFD_CLOEXEC);
+
+  if (input->display == NULL || input->wake_fd == -1)
+    {
+      std::fputs ("ERROR: failed to open the input connection.\n", stderr);
+      std::exit (EXIT_FAILURE);
+    }
+
+  // Without this the server fakes a release before every repeated
+  // press, and a held key looks like a stream of taps. The repeated
+  // presses themselves are dropped in "read_input".
+  XkbSetDetectableAutoRepeat (input->display, True, NULL);
+  XSelectInput (input->display,
+                window.handle,
+                KeyPressMask | KeyReleaseMask);
+  XFlush (input->display);
+
+  input->thread = std::thread (read_input, std::ref (*input));
+
+  return input;
+}
+
+void
+stop_input_thread (InputThread *input)
+{
+  uint64_t const one = 1;
+
+  if (write (input->wake_fd, &one, sizeof (one)) != sizeof (one))
+    std::fputs ("ERROR: failed to stop the input thread.\n", stderr);
+
+  input->thread.join ();
+
+  XCloseDisplay (input->display);
+  ::close (input->wake_fd);
+
+  delete input;
+}
@@ -0,0 +1,65 @@
+#ifndef INPUT_THREAD_HPP
+#define INPUT_THREAD_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <X11/Xlib.h>
+#include "X11Window.hpp"
+
+// A key going down or up, stamped with "now_ns" when it was read off the
+// connection. Presses and releases of a key alternate: auto-repeat is
+// filtered out, so a key held down is one press and, eventually, one
+// release.
+struct KeyEvent
+{
+  uint64_t time;
+  KeySym keysym;
+  bool is_press;
+};
+
+#define KEY_QUEUE_CAPACITY 256
+
+// Single producer, single consumer ring. The producer only writes
+// "tail", the consumer only writes "head", each on its own cache line.
+struct KeyQueue
+{
+  std::atomic<uint32_t> head;
+  char head_padding[64 - sizeof (std::atomic<uint32_t>)];
+  std::atomic<uint32_t> tail;
+  char tail_padding[64 - sizeof (std::atomic<uint32_t>)];
+
+  KeyEvent events[KEY_QUEUE_CAPACITY];
+};
+
+// False if the queue is full.
+bool
+push (KeyQueue &queue, const KeyEvent &event);
+
+// Oldest event, NULL if there is none. Stays valid until "pop".
+const KeyEvent *
+peek (KeyQueue &queue);
+
+void
+pop (KeyQueue &queue);
+
+// Reads the keyboard of "window" on its own thread, over its own
+// connection to the X server, and feeds "queue". The thread sleeps in
+// poll() between events.
+struct InputThread
+{
+  Display *display;
+  // Written to stop the thread.
+  int wake_fd;
+  std::thread thread;
+
+  KeyQueue queue;
+};
+
+InputThread *
+start_input_thread (const X11Window &window);
+
+void
+stop_input_thread (InputThread *input);
+
+#endif // INPUT_THREAD_HPP
@@ -0,0 +1,79 @@
+#ifndef INSTANCE_HPP
+#define INSTANCE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include "AABB.hpp"
+
+// What the GPU gets per quad, 12 bytes where an "AABB" takes 16: the
+// box as half floats, then an RGB color and a state byte that quad.vert
+// reads together as one "uvec4".
+struct Instance
+{
+  // "pos.x, pos.y, shape.x, shape.y".
+  uint16_t rect[4];
+  uint8_t color[3];
+  // Hit points left for blocks, so zero for dead ones, which are not
+  // drawn. One for the slab and balls.
+  uint8_t state;
+};
+
+static_assert (sizeof (Instance) == 12, "instances are tightly packed");
+
+// IEEE half float, rounded to nearest. Halves have 10 bits of mantissa,
+// finer than a pixel across the [-1, 1] playing field. Overflows to
+// infinity, which is also what NaNs become.
+inline uint16_t
+to_half (float value)
+{
+  uint32_t bits;
+  std::memcpy (&bits, &value, sizeof (bits));
+
+  uint16_t const sign = (bits >> 16) & 0x8000;
+  int32_t const exponent = (int32_t)((bits >> 23) & 0xff) - 127 + 15;
+  uint32_t mantissa = bits & 0x7fffff;
+
+  if (exponent >= 31)
+    return sign | 0x7c00;
+
+  if (exponent <= 0)
+    {
+      if (exponent < -10)
+        return sign;
+
+      mantissa |= 0x800000;
+
+      uint32_t const shift = 14 - exponent;
+      uint32_t const half = mantissa >> shift;
+
+      return sign | (half + ((mantissa >> (shift - 1)) & 1));
+    }
+
+  uint16_t const half = sign | exponent << 10 | mantissa >> 13;
+
+  // A carry out of the mantissa correctly bumps the exponent.
+  return half + ((mantissa >> 12) & 1);
+}
+
+inline Instance
+pack_instance (const AABB &box, uint32_t rgb, uint8_t state)
+{
+  Instance instance;
+
+  instance.rect[0] = to_half (box.pos.x);
+  instance.rect[1] = to_half (box.pos.y);
+  instance.rect[2] = to_half (box.shape.x);
+  instance.rect[3] = to_half (box.shape.y);
+  instance.color[0] = rgb >> 16;
+  instance.color[1] = rgb >> 8;
+  instance.color[2] = rgb;
+  instance.state = state;
+
+  return instance;
+}
+
+#define SLAB_COLOR 0xe0e0e0
+#define BALL_COLOR 0xffd040
+#define BLOCK_COLOR 0xff0000
+
+#endif // INSTANCE_HPP
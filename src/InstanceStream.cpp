@@ -0,0 +1,118 @@
+#include <cstring>
+#include "InstanceStream.hpp"
+
+InstanceStream
+create_instance_stream (Arena &arena, uint32_t capacity)
+{
+  InstanceStream stream;
+
+  stream.capacity = capacity;
+  stream.shadow = (Instance *)push (arena, capacity * sizeof (Instance));
+  stream.persistent = GLEW_ARB_buffer_storage;
+  stream.mapped = NULL;
+  stream.segment = 0;
+
+  for (size_t i = 0; i < STREAM_SEGMENTS; i++)
+    stream.pending[i].count = 0;
+
+  {
+    gluint buffer;
+    glCreateBuffers (1, &buffer);
+    stream.buffer = GlBuffer (buffer);
+  }
+
+  if (stream.persistent)
+    {
+      glbitfield const flags =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      size_t const size = STREAM_SEGMENTS * capacity * sizeof (Instance);
+
+      glNamedBufferStorage (stream.buffer, size, NULL, flags);
+      stream.mapped =
+        (Instance *)glMapNamedBufferRange (stream.buffer, 0, size, flags);
+    }
+  else
+    glNamedBufferData (stream.buffer,
+                       capacity * sizeof (Instance),
+                       NULL,
+                       GL_STREAM_DRAW);
+
+  return stream;
+}
+
+void
+stream_dirty (InstanceStream &stream, uint32_t first, uint32_t count)
+{
+  size_t const segments = stream.persistent ? STREAM_SEGMENTS : 1;
+
+  for (size_t i = 0; i < segments; i++)
+    add_range (stream.pending[i], first, count);
+}
+
+uint32_t
+flush (InstanceStream &stream, uint32_t count)
+{
+  DirtyList &pending = stream.pending[stream.segment];
+
+  if (!stream.persistent)
+    {
+      if (pending.count != 0)
+        {
+          glNamedBufferData (stream.buffer,
+                             stream.capacity * sizeof (Instance),
+                             NULL,
+                             GL_STREAM_DRAW);
+          glNamedBufferSubData (stream.buffer,
+                                0,
+                                count * sizeof (Instance),
+                                stream.shadow);
+          pending.count = 0;
+        }
+
+      return 0;
+    }
+
+  GlSync &fence = stream.fences[stream.segment];
+
+  if (fence != 0)
+    {
+      // Normally long signalled: the GPU finished this segment
+      // STREAM_SEGMENTS - 1 frames ago. Only block if it really is that
+      // far behind.
+      if (glClientWaitSync (fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        glClientWaitSync (fence, GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
+
+      fence.reset ();
+    }
+
+  uint32_t const base = stream.segment * stream.capacity;
+
+  for (size_t i = 0; i < pending.count; i++)
+    {
+      uint32_t const first = pending.ranges[i].first;
+      uint32_t last = first + pending.ranges[i].count;
+
+      if (last > count)
+        last = count;
+
+      if (first < last)
+        std::memcpy (stream.mapped + base + first,
+                     stream.shadow + first,
+                     (last - first) * sizeof (Instance));
+    }
+
+  pending.count = 0;
+
+  return base;
+}
+
+void
+end_frame (InstanceStream &stream)
+{
+  if (!stream.persistent)
+    return;
+
+  stream.fences[stream.segment] =
+    GlSync (glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+  stream.segment = (stream.segment + 1) % STREAM_SEGMENTS;
+}
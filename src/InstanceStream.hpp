@@ -0,0 +1,52 @@
+#ifndef INSTANCE_STREAM_HPP
+#define INSTANCE_STREAM_HPP
+
+#include "gl_types.hpp"
+#include "GlObject.hpp"
+#include "Arena.hpp"
+#include "Breakout.hpp"
+#include "Instance.hpp"
+
+// Frames in flight. The GPU reads one segment while the CPU writes the
+// next, with one spare to absorb jitter.
+#define STREAM_SEGMENTS 3
+
+// Instance buffer fed from a CPU shadow copy. Writes to the shadow are
+// marked dirty and reach the GPU once per frame, in "flush".
+//
+// With GL_ARB_buffer_storage the buffer holds STREAM_SEGMENTS copies of
+// the instances, persistently mapped and written in turn, each guarded
+// by a fence. A segment lags the shadow by the ranges dirtied since it
+// was last written, which "pending" keeps per segment. Without the
+// extension the buffer is orphaned and refilled whenever anything
+// changed.
+struct InstanceStream
+{
+  GlBuffer buffer;
+  uint32_t capacity;
+  Instance *shadow;
+
+  bool persistent;
+  Instance *mapped;
+  GlSync fences[STREAM_SEGMENTS];
+  DirtyList pending[STREAM_SEGMENTS];
+  uint32_t segment;
+};
+
+// The shadow is pushed onto "arena".
+InstanceStream
+create_instance_stream (Arena &arena, uint32_t capacity);
+
+void
+stream_dirty (InstanceStream &stream, uint32_t first, uint32_t count);
+
+// Makes the first "count" instances of the shadow visible to the GPU.
+// Returns the base instance to draw them from.
+uint32_t
+flush (InstanceStream &stream, uint32_t count);
+
+// Call once the draw reading this frame's instances has been issued.
+void
+end_frame (InstanceStream &stream);
+
+#endif // INSTANCE_STREAM_HPP
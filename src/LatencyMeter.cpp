@@ -0,0 +1,209 @@
+#include <algorithm>
+#include "Timing.hpp"
+#include "LatencyMeter.hpp"
+
+static const char *const stage_names[Stage_Count] =
+  {
+   "tick", "swap", "gpu"
+  };
+
+LatencyMeter *
+create_latency_meter (void)
+{
+  LatencyMeter *meter = new LatencyMeter ();
+
+  for (auto &frame : meter->frames)
+    {
+      gluint query;
+      glGenQueries (1, &query);
+      frame.query = GlQuery (query);
+    }
+
+  // Both clocks tick in nanoseconds, so one offset maps GPU times onto
+  // ours. Reading GL_TIMESTAMP does not wait for the GPU.
+  GLint64 gpu_time;
+  glGetInteger64v (GL_TIMESTAMP, &gpu_time);
+  meter->gpu_clock_offset = gpu_time - (int64_t)now_ns ();
+
+  return meter;
+}
+
+void
+destroy_latency_meter (LatencyMeter *meter)
+{
+  delete meter;
+}
+
+static void
+record (LatencyMeter &meter, LatencyStage stage, uint64_t latency)
+{
+  size_t const bucket =
+    std::min<uint64_t> (latency / 1000000, LATENCY_BUCKETS - 1);
+
+  meter.histograms[stage][bucket]++;
+  meter.totals[stage] += latency;
+  meter.worst[stage] = std::max (meter.worst[stage], latency);
+}
+
+void
+input_applied (LatencyMeter &meter,
+               uint64_t time,
+               uint64_t applied_time,
+               uint64_t tick)
+{
+  if (meter.pending_count == LATENCY_INPUTS_PER_FRAME)
+    {
+      meter.dropped++;
+      return;
+    }
+
+  meter.applied[meter.pending_count] = applied_time;
+  meter.pending[meter.pending_count++] = { time, tick };
+}
+
+// Frame slots are reused in order, so a slot still in flight belongs to
+// the oldest frame and has to be waited for.
+static void
+collect (LatencyMeter &meter, FrameInFlight &frame, bool wait)
+{
+  if (frame.fence == 0)
+    return;
+
+  glenum const status =
+    glClientWaitSync (frame.fence,
+                      wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                      wait ? UINT64_MAX : 0);
+
+  if (status == GL_TIMEOUT_EXPIRED)
+    return;
+
+  frame.fence.reset ();
+
+  if (frame.input_count == 0)
+    return;
+
+  GLuint64 gpu_time;
+  glGetQueryObjectui64v (frame.query, GL_QUERY_RESULT, &gpu_time);
+
+  uint64_t const done = gpu_time - meter.gpu_clock_offset;
+
+  for (size_t i = 0; i < frame.input_count; i++)
+    {
+      uint64_t const read = frame.inputs[i].time;
+
+      record (meter, Stage_Gpu, done > read ? done - read : 0);
+    }
+
+  frame.input_count = 0;
+}
+
+// Tick "tick" applied the input before updating, so its effect shows
+// from the state after that update on.
+static bool
+is_shown (const TrackedInput &input, uint64_t shown_tick)
+{
+  return input.tick < shown_tick;
+}
+
+void
+frame_drawn (LatencyMeter &meter, uint64_t shown_tick)
+{
+  FrameInFlight &frame = meter.frames[meter.next_frame];
+
+  collect (meter, frame, true);
+
+  for (size_t i = 0; i < meter.pending_count; i++)
+    if (is_shown (meter.pending[i], shown_tick))
+      {
+        glQueryCounter (frame.query, GL_TIMESTAMP);
+        return;
+      }
+}
+
+void
+frame_swapped (LatencyMeter &meter, uint64_t shown_tick)
+{
+  uint64_t const time = now_ns ();
+  FrameInFlight &frame = meter.frames[meter.next_frame];
+  size_t kept = 0;
+
+  frame.input_count = 0;
+
+  for (size_t i = 0; i < meter.pending_count; i++)
+    {
+      TrackedInput const input = meter.pending[i];
+      uint64_t const applied = meter.applied[i];
+
+      if (!is_shown (input, shown_tick))
+        {
+          meter.pending[kept] = input;
+          meter.applied[kept++] = applied;
+          continue;
+        }
+
+      record (meter, Stage_Tick, applied - input.time);
+      record (meter, Stage_Swap, time - input.time);
+      frame.inputs[frame.input_count++] = input;
+    }
+
+  meter.sample_count += frame.input_count;
+  meter.pending_count = kept;
+
+  frame.fence = GlSync (glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+  meter.next_frame = (meter.next_frame + 1) % LATENCY_FRAMES;
+
+  for (auto &other : meter.frames)
+    if (&other != &frame)
+      collect (meter, other, false);
+}
+
+void
+print_latency (const LatencyMeter &meter, FILE *output)
+{
+  std::fprintf (output,
+                "input latency, %llu inputs (%llu not followed):\n",
+                (unsigned long long)meter.sample_count,
+                (unsigned long long)meter.dropped);
+
+  if (meter.sample_count == 0)
+    return;
+
+  for (int stage = 0; stage < Stage_Count; stage++)
+    {
+      uint64_t count = 0;
+
+      for (uint64_t n : meter.histograms[stage])
+        count += n;
+
+      if (count == 0)
+        continue;
+
+      std::fprintf (output,
+                    "  to %-4s avg=%7.3fms max=%7.3fms\n",
+                    stage_names[stage],
+                    (double)meter.totals[stage] / count / 1e6,
+                    meter.worst[stage] / 1e6);
+
+      uint64_t const largest =
+        *std::max_element (meter.histograms[stage],
+                           meter.histograms[stage] + LATENCY_BUCKETS);
+
+      for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+        {
+          uint64_t const n = meter.histograms[stage][bucket];
+
+          if (n == 0)
+            continue;
+
+          int const bar = (int)(n * 40 / largest);
+
+          std::fprintf (output,
+                        "    %2d%s ms %6llu %.*s\n",
+                        bucket,
+                        bucket == LATENCY_BUCKETS - 1 ? "+" : " ",
+                        (unsigned long long)n,
+                        bar > 0 ? bar : 1,
+                        "########################################");
+        }
+    }
+}
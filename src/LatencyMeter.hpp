@@ -0,0 +1,94 @@
+#ifndef LATENCY_METER_HPP
+#define LATENCY_METER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include "gl_types.hpp"
+#include "GlObject.hpp"
+
+// Frames whose GPU completion can be waited on at once. Deeper than any
+// sane swap chain.
+#define LATENCY_FRAMES 8
+// Inputs followed per frame, the rest of a burst is not measured.
+#define LATENCY_INPUTS_PER_FRAME 8
+// One millisecond each, the last one also counts everything slower.
+#define LATENCY_BUCKETS 50
+
+enum LatencyStage
+  {
+   Stage_Tick, Stage_Swap, Stage_Gpu,
+   Stage_Count
+  };
+
+// A key change waiting to be seen: when it was read, and the tick that
+// applied it.
+struct TrackedInput
+{
+  uint64_t time;
+  uint64_t tick;
+};
+
+// A swapped frame the GPU may still be working on. The timestamp query
+// follows its draw, the fence its swap.
+struct FrameInFlight
+{
+  GlQuery query;
+  GlSync fence;
+  TrackedInput inputs[LATENCY_INPUTS_PER_FRAME];
+  size_t input_count;
+};
+
+// Latency from reading an input to: the tick that applied it, the return
+// of the swap showing its effect, and the GPU finishing that frame. The
+// last is the closest thing to the photon GL can tell about; scanout
+// still waits for the next vblank after it.
+struct LatencyMeter
+{
+  // Applied since the last frame.
+  TrackedInput pending[LATENCY_INPUTS_PER_FRAME];
+  size_t pending_count;
+  // Per input, when it reached "Stage_Tick".
+  uint64_t applied[LATENCY_INPUTS_PER_FRAME];
+
+  FrameInFlight frames[LATENCY_FRAMES];
+  size_t next_frame;
+
+  // GL_TIMESTAMP minus "now_ns", measured once.
+  int64_t gpu_clock_offset;
+
+  uint64_t histograms[Stage_Count][LATENCY_BUCKETS];
+  uint64_t totals[Stage_Count];
+  uint64_t worst[Stage_Count];
+  uint64_t sample_count;
+  uint64_t dropped;
+};
+
+// Needs a current context with GL_ARB_timer_query.
+LatencyMeter *
+create_latency_meter (void);
+
+void
+destroy_latency_meter (LatencyMeter *meter);
+
+// Tick "tick" applied an input read at "time" at "applied_time".
+void
+input_applied (LatencyMeter &meter,
+               uint64_t time,
+               uint64_t applied_time,
+               uint64_t tick);
+
+// Call right after the draw calls of a frame showing the state after
+// "shown_tick" ticks.
+void
+frame_drawn (LatencyMeter &meter, uint64_t shown_tick);
+
+// Call right after the swap, with the same tick. Also collects every
+// earlier frame the GPU is done with, without waiting.
+void
+frame_swapped (LatencyMeter &meter, uint64_t shown_tick);
+
+void
+print_latency (const LatencyMeter &meter, FILE *output);
+
+#endif // LATENCY_METER_HPP
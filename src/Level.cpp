@@ -0,0 +1,363 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Utils.hpp"
+#include "Level.hpp"
+
+// Of what a game never changes: block positions and how the grid files
+// them.
+static uint64_t
+fingerprint (const Level &level)
+{
+  BlockStore const &blocks = level.blocks;
+  BlockGrid const &grid = level.grid;
+  size_t const count = blocks.count * sizeof (float);
+  uint64_t hash = FNV1A_OFFSET_BASIS;
+
+  hash = fnv1a (hash, &blocks.count, sizeof (blocks.count));
+  hash = fnv1a (hash, blocks.min_x, count);
+  hash = fnv1a (hash, blocks.min_y, count);
+  hash = fnv1a (hash, blocks.max_x, count);
+  hash = fnv1a (hash, blocks.max_y, count);
+  hash = fnv1a (hash, &grid.origin, sizeof (grid.origin));
+  hash = fnv1a (hash, &grid.cell_size, sizeof (grid.cell_size));
+  hash = fnv1a (hash, &grid.columns, sizeof (grid.columns));
+  hash = fnv1a (hash, &grid.rows, sizeof (grid.rows));
+  hash = fnv1a (hash,
+                grid.cell_first,
+                ((size_t)grid.columns * grid.rows + 1) * sizeof (uint32_t));
+
+  return hash;
+}
+
+// Sorts "blocks" into a store and grid.
+static Level
+create_level (Arena &arena,
+              Arena &scratch,
+              const AABB &ball,
+              const AABB &slab,
+              const AABB *blocks,
+              const uint8_t *hit_points,
+              size_t block_count)
+{
+  Level level;
+
+  level.ball = ball;
+  level.slab = slab;
+
+  ArenaScope scope (scratch);
+  uint32_t *order =
+    (uint32_t *)push (scratch, block_count * sizeof (uint32_t));
+
+  level.grid = create_block_grid (arena, blocks, block_count, order);
+  level.blocks = create_block_store (arena, block_count);
+
+  for (size_t i = 0; i < block_count; i++)
+    {
+      set_block (level.blocks, i, blocks[order[i]]);
+      level.blocks.hit_points[i] = hit_points[order[i]];
+    }
+
+  level.fingerprint = fingerprint (level);
+
+  return level;
+}
+
+Level
+default_level (Arena &arena, Arena &scratch)
+{
+  size_t const block_count = 6 * 5;
+  AABB blocks[block_count];
+  uint8_t hit_points[block_count];
+
+  float x_offset = 0.04, y_offset = 0.04;
+  AABB block =
+    { { -1 + x_offset, 1 - y_offset },
+      { (2 - (6 + 1) * x_offset) / 6, 0.05 } };
+
+  block.pos.y -= block.shape.y;
+
+  for (size_t i = 0; i < block_count; )
+    {
+      blocks[i] = block;
+      hit_points[i] = 1;
+
+      if (++i % 6 != 0)
+        block.pos.x += x_offset + block.shape.x;
+      else
+        {
+          block.pos.x = -1 + x_offset;
+          block.pos.y -= y_offset + block.shape.y;
+        }
+    }
+
+  return create_level (arena,
+                       scratch,
+                       { { 0.0, -0.8 }, { 0.05, 0.05 } },
+                       { { 0.5, -0.8 }, { 0.3, 0.016 } },
+                       blocks,
+                       hit_points,
+                       block_count);
+}
+
+Level
+wall_level (Arena &arena, Arena &scratch, size_t block_count)
+{
+  ArenaScope scope (scratch);
+  AABB *blocks = (AABB *)push (scratch, block_count * sizeof (AABB));
+  uint8_t *hit_points = (uint8_t *)push (scratch, block_count);
+
+  // Twice as wide as high, gaps 4/9 of a row as in the default level.
+  size_t const columns =
+    std::max ((size_t)std::ceil (std::sqrt (2.0 * block_count)), (size_t)1);
+  size_t const rows = (block_count + columns - 1) / columns;
+  float const x_gap = 0.24f / columns;
+  float const row_height =
+    std::min (0.09f, 0.9f / std::max (rows, (size_t)1));
+  Vec2f const shape = { (2 - (columns + 1) * x_gap) / columns,
+                        row_height * 5 / 9 };
+
+  for (size_t i = 0; i < block_count; i++)
+    {
+      size_t const column = i % columns, row = i / columns;
+
+      blocks[i] = { { -1 + x_gap + column * (x_gap + shape.x),
+                      0.96f - row * row_height - shape.y },
+                    shape };
+      hit_points[i] = 1;
+    }
+
+  return create_level (arena,
+                       scratch,
+                       { { 0.0, -0.8 }, { 0.05, 0.05 } },
+                       { { 0.5, -0.8 }, { 0.3, 0.016 } },
+                       blocks,
+                       hit_points,
+                       block_count);
+}
+
+static void
+exit_malformed (const char *filepath, size_t line)
+{
+  std::fprintf (stderr,
+                "ERROR: \'%s\':%zu: malformed level.\n",
+                filepath,
+                line);
+  std::exit (EXIT_FAILURE);
+}
+
+static Level
+load_text_level (Arena &arena, Arena &scratch, const char *filepath)
+{
+  ArenaScope scope (scratch);
+  char *text = read_whole_file (scratch, filepath, NULL);
+
+  // Upper bound on the bricks: one per line.
+  size_t capacity = 1;
+
+  for (const char *at = text; *at != '\0'; at++)
+    capacity += *at == '\n';
+
+  AABB *blocks = (AABB *)push (scratch, capacity * sizeof (AABB));
+  uint8_t *hit_points = (uint8_t *)push (scratch, capacity);
+  size_t block_count = 0;
+
+  AABB ball = { { 0.0, -0.8 }, { 0.05, 0.05 } };
+  AABB slab = { { 0.5, -0.8 }, { 0.3, 0.016 } };
+
+  size_t line_number = 1;
+
+  for (char *line = text; line != NULL; line_number++)
+    {
+      char *next = std::strchr (line, '\n');
+
+      if (next != NULL)
+        *next++ = '\0';
+
+      if (char *comment = std::strchr (line, '#'))
+        *comment = '\0';
+
+      char kind[8];
+      AABB box;
+      unsigned hp = 1;
+      int const fields =
+        std::sscanf (line, "%7s %f %f %f %f %u",
+                     kind, &box.pos.x, &box.pos.y,
+                     &box.shape.x, &box.shape.y, &hp);
+
+      if (fields <= 0)
+        ;
+      else if (fields < 5 || box.shape.x < 0 || box.shape.y < 0)
+        exit_malformed (filepath, line_number);
+      else if (std::strcmp (kind, "ball") == 0 && fields == 5)
+        ball = box;
+      else if (std::strcmp (kind, "slab") == 0 && fields == 5)
+        slab = box;
+      else if (std::strcmp (kind, "brick") == 0 && 1 <= hp && hp <= 255)
+        {
+          blocks[block_count] = box;
+          hit_points[block_count] = hp;
+          block_count++;
+        }
+      else
+        exit_malformed (filepath, line_number);
+
+      line = next;
+    }
+
+  return create_level (arena,
+                       scratch,
+                       ball,
+                       slab,
+                       blocks,
+                       hit_points,
+                       block_count);
+}
+
+static void
+exit_bad_binary (const char *filepath)
+{
+  std::fprintf (stderr,
+                "ERROR: \'%s\' is not a valid binary level.\n",
+                filepath);
+  std::exit (EXIT_FAILURE);
+}
+
+// The mapping is private: pages the game writes to (alive bits, hit
+// points) are copied on first write and never reach the file.
+static Level
+map_binary_level (Arena &arena, const char *filepath, int fd, size_t size)
+{
+  char *data = (char *)push_file (arena, fd, size);
+
+  if (data == NULL)
+    {
+      std::fprintf (stderr,
+                    "ERROR: failed to map file \'%s\'.\n",
+                    filepath);
+      std::exit (EXIT_FAILURE);
+    }
+
+  LevelHeader const &header = *(LevelHeader *)data;
+
+  Level level;
+
+  level.ball = header.ball;
+  level.slab = header.slab;
+  level.grid.origin = header.origin;
+  level.grid.cell_size = header.cell_size;
+  level.grid.columns = header.columns;
+  level.grid.rows = header.rows;
+
+  if (header.version != LEVEL_VERSION
+      || header.byte_order != BYTE_ORDER_MARK
+      || header.live_count > header.block_count
+      || header.columns <= 0 || header.rows <= 0
+      || header.store_size != block_store_size (header.block_count)
+      || header.grid_size != block_grid_size (level.grid)
+      || header.store_offset % 8 != 0 || header.grid_offset % 8 != 0
+      || header.store_offset > size
+      || size - header.store_offset < header.store_size
+      || header.grid_offset > size
+      || size - header.grid_offset < header.grid_size)
+    exit_bad_binary (filepath);
+
+  level.blocks = place_block_store (data + header.store_offset,
+                                    header.block_count,
+                                    header.live_count);
+  place_block_grid (level.grid, data + header.grid_offset);
+  level.fingerprint = header.fingerprint;
+
+  return level;
+}
+
+Level
+load_level (Arena &arena, Arena &scratch, const char *filepath)
+{
+  int const fd = open (filepath, O_RDONLY);
+
+  if (fd == -1)
+    {
+      std::fprintf (stderr,
+                    "ERROR: failed to open file \'%s\'.\n",
+                    filepath);
+      std::exit (EXIT_FAILURE);
+    }
+
+  struct stat stats;
+  char magic[4];
+
+  if (fstat (fd, &stats) == -1)
+    std::exit (EXIT_FAILURE);
+
+  bool const is_binary =
+    (size_t)stats.st_size >= sizeof (LevelHeader)
+    && read (fd, magic, 4) == 4
+    && std::memcmp (magic, LEVEL_MAGIC, 4) == 0;
+
+  Level level = (is_binary
+                 ? map_binary_level (arena, filepath, fd, stats.st_size)
+                 : load_text_level (arena, scratch, filepath));
+
+  ::close (fd);
+
+  return level;
+}
+
+void
+save_binary_level (const Level &level, const char *filepath)
+{
+  LevelHeader header;
+
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, LEVEL_MAGIC, 4);
+  header.version = LEVEL_VERSION;
+  header.byte_order = BYTE_ORDER_MARK;
+  header.block_count = level.blocks.count;
+  header.live_count = level.blocks.live_count;
+  header.columns = level.grid.columns;
+  header.rows = level.grid.rows;
+  header.origin = level.grid.origin;
+  header.cell_size = level.grid.cell_size;
+  header.ball = level.ball;
+  header.slab = level.slab;
+  header.fingerprint = level.fingerprint;
+  header.store_offset = align8 (sizeof (header));
+  header.store_size = block_store_size (level.blocks.count);
+  header.grid_offset = align8 (header.store_offset + header.store_size);
+  header.grid_size = block_grid_size (level.grid);
+
+  FILE *const file = std::fopen (filepath, "wb");
+
+  if (file == NULL)
+    {
+      std::fprintf (stderr,
+                    "ERROR: failed to open file \'%s\'.\n",
+                    filepath);
+      std::exit (EXIT_FAILURE);
+    }
+
+  char const padding[8] = { 0 };
+
+  std::fwrite (&header, sizeof (header), 1, file);
+  std::fwrite (padding, 1, header.store_offset - sizeof (header), file);
+  std::fwrite (level.blocks.min_x, 1, header.store_size, file);
+  std::fwrite (padding,
+               1,
+               header.grid_offset - header.store_offset - header.store_size,
+               file);
+  std::fwrite (level.grid.cell_first, 1, header.grid_size, file);
+
+  if (std::fclose (file) != 0)
+    {
+      std::fprintf (stderr,
+                    "ERROR: failed to write file \'%s\'.\n",
+                    filepath);
+      std::exit (EXIT_FAILURE);
+    }
+}
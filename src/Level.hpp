@@ -0,0 +1,74 @@
+#ifndef LEVEL_HPP
+#define LEVEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "AABB.hpp"
+#include "Grid.hpp"
+#include "BlockStore.hpp"
+#include "Arena.hpp"
+
+// Text levels have one item per line, "#" starts a comment:
+//
+//   ball X Y WIDTH HEIGHT
+//   slab X Y WIDTH HEIGHT
+//   brick X Y WIDTH HEIGHT [HIT_POINTS]
+//
+// Binary levels are a "LevelHeader" followed by the block store and grid
+// exactly as they sit in memory, so loading one is an mmap and a few
+// pointer assignments. They are native-endian and only meant to be read
+// back by the build that wrote them.
+#define LEVEL_MAGIC "BKLV"
+#define LEVEL_VERSION 2
+
+struct LevelHeader
+{
+  char magic[4];
+  uint32_t version;
+  // Written as 0x01020304, to reject files from other byte orders.
+  uint32_t byte_order;
+  uint32_t block_count;
+  uint32_t live_count;
+  int32_t columns, rows;
+  Vec2f origin, cell_size;
+  AABB ball, slab;
+  // The level's, so that loading does not have to read every block.
+  uint64_t fingerprint;
+  uint64_t store_offset, store_size;
+  uint64_t grid_offset, grid_size;
+};
+
+struct Level
+{
+  AABB ball, slab;
+  BlockStore blocks;
+  BlockGrid grid;
+  // Hash of the block positions and grid cells that tells apart levels
+  // of the same size. Taken when a level is built from its bricks, and
+  // stored in binary levels.
+  uint64_t fingerprint;
+};
+
+// Levels live on "arena", along with the game they start. Loading uses
+// "scratch" for temporaries and leaves it as it found it.
+#define LEVEL_ARENA_SIZE ((size_t)1 << 30)
+
+// The 6x5 wall of bricks the game started out with.
+Level
+default_level (Arena &arena, Arena &scratch);
+
+// "block_count" bricks in rows filling the top half of the field, as
+// square as the field allows, otherwise like the default level. For
+// benchmarks and tests of large levels.
+Level
+wall_level (Arena &arena, Arena &scratch, size_t block_count);
+
+// Binary levels are recognized by their magic, anything else is parsed
+// as text. Binary levels are mapped onto "arena" rather than copied.
+Level
+load_level (Arena &arena, Arena &scratch, const char *filepath);
+
+void
+save_binary_level (const Level &level, const char *filepath);
+
+#endif // LEVEL_HPP
@@ -0,0 +1,191 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <GL/glew.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include "OffscreenWindow.hpp"
+
+static bool
+has_extension (const char *extensions, const char *name)
+{
+  size_t const length = std::strlen (name);
+
+  for (const char *at = extensions;
+       at != NULL && (at = std::strstr (at, name)) != NULL;
+       at += length)
+    if ((at == extensions || at[-1] == ' ')
+        && (at[length] == ' ' || at[length] == '\0'))
+      return true;
+
+  return false;
+}
+
+// The surfaceless platform needs neither a display server nor a GPU.
+// Elsewhere whatever EGL picks by default has to do.
+static EGLDisplay
+open_display (void)
+{
+  const char *const client_extensions =
+    eglQueryString (EGL_NO_DISPLAY, EGL_EXTENSIONS);
+
+  if (has_extension (client_extensions, "EGL_MESA_platform_surfaceless"))
+    {
+      auto const get_platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+        eglGetProcAddress ("eglGetPlatformDisplayEXT");
+
+      if (get_platform_display != NULL)
+        {
+          EGLDisplay const display =
+            get_platform_display (EGL_PLATFORM_SURFACELESS_MESA,
+                                  EGL_DEFAULT_DISPLAY,
+                                  NULL);
+
+          if (display != EGL_NO_DISPLAY)
+            return display;
+        }
+    }
+
+  return eglGetDisplay (EGL_DEFAULT_DISPLAY);
+}
+
+static void
+fail (const char *what)
+{
+  std::fprintf (stderr,
+                "ERROR: failed to %s (EGL error 0x%x).\n",
+                what,
+                eglGetError ());
+  std::exit (EXIT_FAILURE);
+}
+
+OffscreenWindow
+create_offscreen_window (uint32_t width, uint32_t height)
+{
+  OffscreenWindow window;
+
+  window.should_close = false;
+  window.width = width;
+  window.height = height;
+  window.display = open_display ();
+
+  if (window.display == EGL_NO_DISPLAY
+      || !eglInitialize (window.display, NULL, NULL))
+    fail ("open an EGL display");
+
+  if (!eglBindAPI (EGL_OPENGL_API))
+    fail ("bind OpenGL");
+
+  EGLint const config_attributes[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                                       EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                                       EGL_RED_SIZE, 8,
+                                       EGL_GREEN_SIZE, 8,
+                                       EGL_BLUE_SIZE, 8,
+                                       EGL_NONE };
+  EGLConfig config;
+  EGLint config_count;
+
+  if (!eglChooseConfig (window.display,
+                        config_attributes,
+                        &config,
+                        1,
+                        &config_count)
+      || config_count == 0)
+    fail ("find an EGL config");
+
+  // Same as glXCreateContext: the most recent compatibility profile.
+  window.context =
+    eglCreateContext (window.display, config, EGL_NO_CONTEXT, NULL);
+
+  if (window.context == EGL_NO_CONTEXT)
+    fail ("create an EGL context");
+
+  // Drawing goes to the framebuffer object, so a surface is only needed
+  // where contexts cannot be made current without one.
+  window.surface = EGL_NO_SURFACE;
+
+  if (!has_extension (eglQueryString (window.display, EGL_EXTENSIONS),
+                      "EGL_KHR_surfaceless_context"))
+    {
+      EGLint const surface_attributes[] = { EGL_WIDTH, 1,
+                                            EGL_HEIGHT, 1,
+                                            EGL_NONE };
+
+      window.surface = eglCreatePbufferSurface (window.display,
+                                                config,
+                                                surface_attributes);
+
+      if (window.surface == EGL_NO_SURFACE)
+        fail ("create a pbuffer");
+    }
+
+  if (!eglMakeCurrent (window.display,
+                       window.surface,
+                       window.surface,
+                       window.context))
+    fail ("make the EGL context current");
+
+  // glewInit() also looks for a GLX display, which there is none of.
+  if (glewContextInit () != GLEW_OK)
+    {
+      std::fputs ("ERROR: failed to initialize glew.\n", stderr);
+      std::exit (EXIT_FAILURE);
+    }
+
+  {
+    gluint framebuffer, color_buffer;
+    glGenFramebuffers (1, &framebuffer);
+    glGenRenderbuffers (1, &color_buffer);
+    window.framebuffer = GlFramebuffer (framebuffer);
+    window.color_buffer = GlRenderbuffer (color_buffer);
+  }
+
+  glBindRenderbuffer (GL_RENDERBUFFER, window.color_buffer);
+  glRenderbufferStorage (GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+  glBindFramebuffer (GL_FRAMEBUFFER, window.framebuffer);
+  glFramebufferRenderbuffer (GL_FRAMEBUFFER,
+                             GL_COLOR_ATTACHMENT0,
+                             GL_RENDERBUFFER,
+                             window.color_buffer);
+
+  if (glCheckFramebufferStatus (GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+      std::fputs ("ERROR: offscreen framebuffer is incomplete.\n", stderr);
+      std::exit (EXIT_FAILURE);
+    }
+
+  glViewport (0, 0, width, height);
+
+  return window;
+}
+
+void
+close (OffscreenWindow &window)
+{
+  window.framebuffer.reset ();
+  window.color_buffer.reset ();
+
+  eglMakeCurrent (window.display,
+                  EGL_NO_SURFACE,
+                  EGL_NO_SURFACE,
+                  EGL_NO_CONTEXT);
+  eglDestroyContext (window.display, window.context);
+
+  if (window.surface != EGL_NO_SURFACE)
+    eglDestroySurface (window.display, window.surface);
+
+  eglTerminate (window.display);
+}
+
+void
+process_events (OffscreenWindow &)
+{
+}
+
+void
+swap_buffers (OffscreenWindow &)
+{
+  glFlush ();
+}
@@ -0,0 +1,42 @@
+#ifndef OFFSCREEN_WINDOW_HPP
+#define OFFSCREEN_WINDOW_HPP
+
+#include <cstdint>
+#include <EGL/egl.h>
+#include "gl_types.hpp"
+#include "GlObject.hpp"
+
+// Stands in for "X11Window" where there is no display: an EGL context,
+// surfaceless where the driver allows it, drawing into a framebuffer
+// object of the window's size. Works on Mesa's software rasterizer.
+struct OffscreenWindow
+{
+  EGLDisplay display;
+  EGLSurface surface;
+  EGLContext context;
+  uint32_t width, height;
+
+  // Bound for drawing and reading from creation on.
+  GlFramebuffer framebuffer;
+  GlRenderbuffer color_buffer;
+
+  bool should_close;
+};
+
+// Leaves the context current and GLEW initialized.
+OffscreenWindow
+create_offscreen_window (uint32_t width, uint32_t height);
+
+void
+close (OffscreenWindow &window);
+
+// Nothing happens to an offscreen window.
+void
+process_events (OffscreenWindow &window);
+
+// Ends the frame. Nothing is shown, but the frame can be read back from
+// the framebuffer until drawing starts again.
+void
+swap_buffers (OffscreenWindow &window);
+
+#endif // OFFSCREEN_WINDOW_HPP
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <mutex>
+#include "Profiler.hpp"
+
+// Samples past the ring's capacity within one interval overwrite the
+// oldest ones, so the statistics cover the most recent samples.
+#define RING_CAPACITY 4096
+
+struct SampleRing
+{
+  uint64_t samples[RING_CAPACITY];
+  size_t next;
+  size_t count;
+};
+
+static const char *const zone_names[Zone_Count] =
+  {
+   "process_events", "update", "draw", "swap_buffers"
+  };
+
+bool profiling_enabled = false;
+
+// Zones are timed on both the simulation and the render thread.
+static std::mutex rings_mutex;
+static SampleRing rings[Zone_Count];
+static uint64_t scratch[RING_CAPACITY];
+
+static FILE *profile_output = NULL;
+static bool profile_as_csv = false;
+static uint64_t dump_interval_ns = 0;
+static uint64_t profiling_started = 0;
+static uint64_t last_dump = 0;
+
+void
+start_profiling (FILE *output, bool csv, uint64_t interval_ns)
+{
+  for (auto &ring : rings)
+    ring.next = ring.count = 0;
+
+  profile_output = output;
+  profile_as_csv = csv;
+  dump_interval_ns = interval_ns;
+  profiling_started = last_dump = now_ns ();
+  profiling_enabled = true;
+
+  if (csv)
+    std::fputs ("time_s,zone,samples,min_us,avg_us,p99_us\n", output);
+}
+
+void
+stop_profiling (void)
+{
+  profiling_enabled = false;
+  std::fflush (profile_output);
+}
+
+void
+record_sample (ProfileZone zone, uint64_t duration_ns)
+{
+  std::lock_guard<std::mutex> lock (rings_mutex);
+  SampleRing &ring = rings[zone];
+
+  ring.samples[ring.next] = duration_ns;
+  ring.next = (ring.next + 1) % RING_CAPACITY;
+
+  if (ring.count < RING_CAPACITY)
+    ring.count++;
+}
+
+static void
+dump_statistics (uint64_t time)
+{
+  double const seconds = (time - profiling_started) / 1e9;
+
+  if (!profile_as_csv)
+    std::fprintf (profile_output, "profile @ %.3fs:\n", seconds);
+
+  for (int zone = 0; zone < Zone_Count; zone++)
+    {
+      SampleRing &ring = rings[zone];
+
+      if (ring.count == 0)
+        continue;
+
+      std::copy (ring.samples, ring.samples + ring.count, scratch);
+
+      uint64_t min = scratch[0], total = 0;
+
+      for (size_t i = 0; i < ring.count; i++)
+        {
+          min = std::min (min, scratch[i]);
+          total += scratch[i];
+        }
+
+      size_t const p99_index = ring.count * 99 / 100;
+      std::nth_element (scratch, scratch + p99_index, scratch + ring.count);
+
+      double const min_us = min / 1e3;
+      double const avg_us = (double)total / ring.count / 1e3;
+      double const p99_us = scratch[p99_index] / 1e3;
+
+      if (profile_as_csv)
+        std::fprintf (profile_output, "%.3f,%s,%zu,%.3f,%.3f,%.3f\n",
+                      seconds, zone_names[zone], ring.count,
+                      min_us, avg_us, p99_us);
+      else
+        std::fprintf (profile_output,
+                      "  %-15s n=%-6zu min=%9.3fus avg=%9.3fus"
+                      " p99=%9.3fus\n",
+                      zone_names[zone], ring.count,
+                      min_us, avg_us, p99_us);
+
+      ring.next = ring.count = 0;
+    }
+
+  std::fflush (profile_output);
+}
+
+void
+end_profiled_frame (void)
+{
+  if (!profiling_enabled)
+    return;
+
+  uint64_t const time = now_ns ();
+
+  if (time - last_dump >= dump_interval_ns)
+    {
+      std::lock_guard<std::mutex> lock (rings_mutex);
+      dump_statistics (time);
+      last_dump = time;
+    }
+}
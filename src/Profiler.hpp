@@ -0,0 +1,53 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include "Timing.hpp"
+
+enum ProfileZone
+  {
+   Zone_ProcessEvents, Zone_Update, Zone_Draw, Zone_SwapBuffers,
+   Zone_Count
+  };
+
+extern bool profiling_enabled;
+
+// Starts collecting samples. Every "interval_ns" the per-zone min/avg/p99
+// over the collected samples is written to "output", as CSV rows if "csv"
+// is set.
+void
+start_profiling (FILE *output, bool csv, uint64_t interval_ns);
+
+void
+stop_profiling (void);
+
+// Safe to call from any thread between start_profiling() and
+// stop_profiling().
+void
+record_sample (ProfileZone zone, uint64_t duration_ns);
+
+// Writes the statistics if the dump interval has passed. Call from one
+// thread only.
+void
+end_profiled_frame (void);
+
+// Times the enclosing scope. Costs one branch while profiling is off.
+struct ScopedZone
+{
+  ProfileZone zone;
+  uint64_t start;
+
+  explicit ScopedZone (ProfileZone zone)
+    : zone (zone), start (profiling_enabled ? now_ns () : 0)
+  {
+  }
+
+  ~ScopedZone ()
+  {
+    if (profiling_enabled)
+      record_sample (zone, now_ns () - start);
+  }
+};
+
+#endif // PROFILER_HPP
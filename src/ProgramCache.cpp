@@ -0,0 +1,251 @@
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cinttypes>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Utils.hpp"
+#include "Shader.hpp"
+#include "ProgramCache.hpp"
+
+#define PROGRAM_CACHE_MAGIC "BKPB"
+
+// Followed by the binary itself.
+struct ProgramCacheHeader
+{
+  char magic[4];
+  glenum format;
+};
+
+static bool
+make_directory (const char *path)
+{
+  return mkdir (path, 0755) == 0 || errno == EEXIST;
+}
+
+static bool
+cache_path (char *path, size_t size, uint64_t key)
+{
+  char directory[PATH_MAX];
+  const char *cache_home = std::getenv ("XDG_CACHE_HOME");
+  const char *home = std::getenv ("HOME");
+
+  if (cache_home != NULL && cache_home[0] == '/')
+    std::snprintf (directory, sizeof (directory), "%s", cache_home);
+  else if (home != NULL && home[0] == '/')
+    std::snprintf (directory, sizeof (directory), "%s/.cache", home);
+  else
+    return false;
+
+  if (!make_directory (directory))
+    return false;
+
+  std::strncat (directory,
+                "/breakout",
+                sizeof (directory) - std::strlen (directory) - 1);
+
+  if (!make_directory (directory))
+    return false;
+
+  int const length = std::snprintf (path,
+                                    size,
+                                    "%s/%016" PRIx64 ".program",
+                                    directory,
+                                    key);
+
+  return 0 < length && (size_t)length < size;
+}
+
+static uint64_t
+hash_string (uint64_t hash, const char *string)
+{
+  // The terminator keeps "ab" + "c" apart from "a" + "bc".
+  return fnv1a (hash,
+                string,
+                string != NULL ? std::strlen (string) + 1 : 0);
+}
+
+// Binaries are only valid for the driver that produced them.
+static uint64_t
+program_key (const char *source, const char *fragment_source)
+{
+  glenum const driver_strings[] =
+    { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION };
+  uint64_t hash = FNV1A_OFFSET_BASIS;
+
+  for (glenum name : driver_strings)
+    hash = hash_string (hash, (const char *)glGetString (name));
+
+  hash = hash_string (hash, source);
+  hash = hash_string (hash, fragment_source);
+
+  return hash;
+}
+
+static bool
+load_binary (Arena &scratch, const char *path, gluint program)
+{
+  FILE *const file = std::fopen (path, "rb");
+
+  if (file == NULL)
+    return false;
+
+  ArenaScope scope (scratch);
+  struct stat stats;
+  char *data = NULL;
+  size_t size = 0;
+
+  if (fstat (fileno (file), &stats) == 0
+      && (size_t)stats.st_size > sizeof (ProgramCacheHeader))
+    {
+      size = stats.st_size;
+      data = (char *)push (scratch, size);
+
+      if (std::fread (data, 1, size, file) != size)
+        data = NULL;
+    }
+
+  std::fclose (file);
+
+  if (data == NULL)
+    return false;
+
+  ProgramCacheHeader header;
+
+  std::memcpy (&header, data, sizeof (header));
+
+  if (std::memcmp (header.magic, PROGRAM_CACHE_MAGIC, 4) != 0)
+    return false;
+
+  // Drivers reject binaries they do not like, such as ones from an older
+  // build of themselves, by failing the link.
+  glint is_ok;
+  glProgramBinary (program,
+                   header.format,
+                   data + sizeof (header),
+                   size - sizeof (header));
+  glGetProgramiv (program, GL_LINK_STATUS, &is_ok);
+
+  return is_ok == GL_TRUE;
+}
+
+// Written to a file of its own next to its final name and renamed over
+// it, so concurrent runs never read, or rename, half a binary.
+static void
+store_binary (Arena &scratch, const char *path, gluint program)
+{
+  glint length = 0;
+  glGetProgramiv (program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+  if (length <= 0)
+    return;
+
+  ArenaScope scope (scratch);
+  ProgramCacheHeader header;
+  char *binary = (char *)push (scratch, length);
+  glsizei written = 0;
+
+  std::memcpy (header.magic, PROGRAM_CACHE_MAGIC, 4);
+  glGetProgramBinary (program, length, &written, &header.format, binary);
+
+  char temporary[PATH_MAX];
+
+  if (written <= 0
+      || std::snprintf (temporary, sizeof (temporary), "%s.XXXXXX", path)
+         >= (int)sizeof (temporary))
+    return;
+
+  int const fd = mkstemp (temporary);
+
+  if (fd == -1)
+    return;
+
+  FILE *const file = fdopen (fd, "wb");
+
+  if (file == NULL)
+    {
+      ::close (fd);
+      std::remove (temporary);
+      return;
+    }
+
+  bool const is_ok =
+    std::fwrite (&header, sizeof (header), 1, file) == 1
+    && std::fwrite (binary, 1, written, file) == (size_t)written;
+
+  if (std::fclose (file) == 0 && is_ok)
+    std::rename (temporary, path);
+  else
+    std::remove (temporary);
+}
+
+// Programs below are built from a vertex and a fragment shader, or from
+// "source" alone as a compute shader when "fragment_source" is NULL.
+static GlProgram
+compile_program (Arena &scratch,
+                 const char *source,
+                 const char *fragment_source)
+{
+  if (fragment_source == NULL)
+    {
+      GlShader const compute_shader =
+        create_shader (scratch, GL_COMPUTE_SHADER, source);
+
+      return create_compute_program (scratch, compute_shader);
+    }
+
+  GlShader const vertex_shader =
+    create_shader (scratch, GL_VERTEX_SHADER, source);
+  GlShader const fragment_shader =
+    create_shader (scratch, GL_FRAGMENT_SHADER, fragment_source);
+
+  return create_program (scratch, vertex_shader, fragment_shader);
+}
+
+static GlProgram
+load (Arena &scratch, const char *source, const char *fragment_source)
+{
+  glint format_count = 0;
+
+  if (GLEW_ARB_get_program_binary)
+    glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+
+  char path[PATH_MAX];
+
+  if (format_count <= 0
+      || !cache_path (path,
+                      sizeof (path),
+                      program_key (source, fragment_source)))
+    return compile_program (scratch, source, fragment_source);
+
+  {
+    GlProgram program (glCreateProgram ());
+
+    if (load_binary (scratch, path, program))
+      return program;
+  }
+
+  GlProgram program =
+    compile_program (scratch, source, fragment_source);
+
+  if (program != 0)
+    store_binary (scratch, path, program);
+
+  return program;
+}
+
+GlProgram
+load_program (Arena &scratch,
+              const char *vertex_source,
+              const char *fragment_source)
+{
+  return load (scratch, vertex_source, fragment_source);
+}
+
+GlProgram
+load_compute_program (Arena &scratch, const char *source)
+{
+  return load (scratch, source, NULL);
+}
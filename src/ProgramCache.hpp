@@ -0,0 +1,23 @@
+#ifndef PROGRAM_CACHE_HPP
+#define PROGRAM_CACHE_HPP
+
+#include "gl_types.hpp"
+#include "GlObject.hpp"
+#include "Arena.hpp"
+
+// Links a program from its sources, or reloads the binary an earlier run
+// linked from the same sources on the same driver. Binaries live in
+// "$XDG_CACHE_HOME/breakout" (or "~/.cache/breakout"), one file per
+// hash of the driver strings and sources. Anything unusable about the
+// cache, or a driver without GL_ARB_get_program_binary, falls back to
+// compiling. Null if compiling fails.
+GlProgram
+load_program (Arena &scratch,
+              const char *vertex_source,
+              const char *fragment_source);
+
+// Same for a compute program. Needs GL 4.3.
+GlProgram
+load_compute_program (Arena &scratch, const char *source);
+
+#endif // PROGRAM_CACHE_HPP
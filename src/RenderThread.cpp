@@ -0,0 +1,214 @@
+#include <cstdio>
+#include <cstdlib>
+#include <GL/glew.h>
+#include <GL/glxew.h>
+#include "Arena.hpp"
+#include "Level.hpp"
+#include "Timing.hpp"
+#include "Profiler.hpp"
+#include "Renderer.hpp"
+#include "LatencyMeter.hpp"
+#include "RenderThread.hpp"
+
+static void
+render_frames (RenderThread &render)
+{
+  X11Window &window = *render.window;
+
+  glXMakeCurrent (window.display, window.handle, window.context);
+
+  if (GLX_EXT_swap_control)
+    glXSwapIntervalEXT (window.display, window.handle, 1);
+
+  glClearColor (0.4, 0.4, 0.4, 1.0);
+
+  for (glenum error; (error = glGetError ()) != GL_NO_ERROR; )
+    {
+      std::fprintf (stderr, "ERROR: detected OpenGL error: %i.\n", error);
+    }
+
+  LatencyMeter *latency = NULL;
+
+  if (render.measure_latency)
+    {
+      if (!GLEW_ARB_timer_query)
+        {
+          std::fputs ("ERROR: latency needs GL_ARB_timer_query.\n", stderr);
+          std::exit (EXIT_FAILURE);
+        }
+
+      latency = create_latency_meter ();
+    }
+
+  // The instance shadow is sized by the level, like the level itself.
+  Arena arena = create_arena (LEVEL_ARENA_SIZE);
+  Arena scratch = create_arena (SCRATCH_ARENA_SIZE);
+
+  auto start_renderer =
+    [&]() -> Renderer
+    {
+      reset_arena (arena);
+
+      Renderer renderer = create_renderer (arena,
+                                           scratch,
+                                           render.snapshots->block_count,
+                                           render.snapshots->ball_capacity);
+
+      if (render.shader_directory != NULL)
+        reload_program (renderer, scratch, render.shader_directory);
+
+      return renderer;
+    };
+
+  Renderer renderer = start_renderer ();
+
+  while (!render.stopping.load (std::memory_order_relaxed))
+    {
+      if (render.park_requested.load (std::memory_order_acquire))
+        {
+          renderer = Renderer ();
+
+          {
+            std::unique_lock<std::mutex> lock (render.mutex);
+
+            render.parked = true;
+            render.parked_changed.notify_all ();
+            render.parked_changed.wait (lock,
+                                        [&] { return !render.park_requested; });
+            render.parked = false;
+          }
+
+          renderer = start_renderer ();
+        }
+
+      if (render.reload_requested.exchange (false, std::memory_order_relaxed)
+          && render.shader_directory != NULL)
+        reload_program (renderer, scratch, render.shader_directory);
+
+      glClear (GL_COLOR_BUFFER_BIT);
+
+      bool is_new;
+      FrameSnapshot &snapshot = acquire (*render.snapshots, is_new);
+
+      {
+        ScopedZone zone (Zone_Draw);
+
+        if (latency != NULL && is_new)
+          for (size_t i = 0; i < snapshot.input_count; i++)
+            input_applied (*latency,
+                           snapshot.inputs[i].read_time,
+                           snapshot.inputs[i].applied_time,
+                           snapshot.inputs[i].tick);
+
+        float const alpha =
+          interpolation_alpha (snapshot.time, render.tick_ns, now_ns ());
+
+        upload (renderer, snapshot, is_new, alpha);
+        draw (renderer, snapshot);
+
+        if (latency != NULL)
+          frame_drawn (*latency, snapshot.tick);
+      }
+
+      {
+        ScopedZone zone (Zone_SwapBuffers);
+        swap_buffers (window);
+
+        if (latency != NULL)
+          frame_swapped (*latency, snapshot.tick);
+      }
+
+      // Cold start: launch to the first frame handed to the display,
+      // shader compilation or program cache included.
+      if (render.launch_time != 0)
+        {
+          if (profiling_enabled)
+            std::fprintf (stderr,
+                          "startup: %.2f ms\n",
+                          (now_ns () - render.launch_time) / 1e6);
+
+          render.launch_time = 0;
+        }
+
+      reset_arena (scratch);
+    }
+
+  if (latency != NULL)
+    {
+      print_latency (*latency, stderr);
+      destroy_latency_meter (latency);
+    }
+
+  // GL objects have to go while the context is still current.
+  renderer = Renderer ();
+  destroy_arena (scratch);
+  destroy_arena (arena);
+
+  glXMakeCurrent (window.display, None, NULL);
+}
+
+RenderThread *
+start_render_thread (X11Window &window,
+                     SnapshotBuffer *snapshots,
+                     uint64_t tick_ns,
+                     const char *shader_directory,
+                     bool measure_latency,
+                     uint64_t launch_time)
+{
+  RenderThread *render = new RenderThread;
+
+  render->window = &window;
+  render->snapshots = snapshots;
+  render->tick_ns = tick_ns;
+  render->shader_directory = shader_directory;
+  render->measure_latency = measure_latency;
+  render->launch_time = launch_time;
+  render->stopping.store (false, std::memory_order_relaxed);
+  render->reload_requested.store (false, std::memory_order_relaxed);
+  render->park_requested.store (false, std::memory_order_relaxed);
+  render->parked = false;
+
+  // A context is current on one thread at a time.
+  glXMakeCurrent (window.display, None, NULL);
+
+  render->thread = std::thread (render_frames, std::ref (*render));
+
+  return render;
+}
+
+void
+stop_render_thread (RenderThread *render)
+{
+  render->stopping.store (true, std::memory_order_relaxed);
+  render->thread.join ();
+
+  delete render;
+}
+
+void
+request_shader_reload (RenderThread &render)
+{
+  render.reload_requested.store (true, std::memory_order_relaxed);
+}
+
+void
+park_render_thread (RenderThread &render)
+{
+  std::unique_lock<std::mutex> lock (render.mutex);
+
+  render.park_requested.store (true, std::memory_order_release);
+  render.parked_changed.wait (lock, [&] { return render.parked; });
+}
+
+void
+resume_render_thread (RenderThread &render, SnapshotBuffer *snapshots)
+{
+  {
+    std::lock_guard<std::mutex> lock (render.mutex);
+
+    render.snapshots = snapshots;
+    render.park_requested.store (false, std::memory_order_relaxed);
+  }
+
+  render.parked_changed.notify_all ();
+}
@@ -0,0 +1,63 @@
+#ifndef RENDER_THREAD_HPP
+#define RENDER_THREAD_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "X11Window.hpp"
+#include "FrameSnapshot.hpp"
+
+// Draws the newest snapshot of "snapshots" on its own thread, which owns
+// the GL context from start to stop. The simulation never waits for a
+// swap, and the renderer never waits for a tick.
+struct RenderThread
+{
+  X11Window *window;
+  std::thread thread;
+
+  SnapshotBuffer *snapshots;
+  uint64_t tick_ns;
+  // NULL to keep the built in shaders.
+  const char *shader_directory;
+  bool measure_latency;
+  // Zero once the first frame is out.
+  uint64_t launch_time;
+
+  std::atomic<bool> stopping;
+  std::atomic<bool> reload_requested;
+
+  // While parked the renderer holds no GL objects and does not touch
+  // "snapshots", so the game behind them can be replaced.
+  std::atomic<bool> park_requested;
+  std::mutex mutex;
+  std::condition_variable parked_changed;
+  bool parked;
+};
+
+// Takes over the context of "window", which has to be current on the
+// calling thread. Gives it back on stop.
+RenderThread *
+start_render_thread (X11Window &window,
+                     SnapshotBuffer *snapshots,
+                     uint64_t tick_ns,
+                     const char *shader_directory,
+                     bool measure_latency,
+                     uint64_t launch_time);
+
+void
+stop_render_thread (RenderThread *render);
+
+// Rebuilds the program from "shader_directory" before the next frame.
+void
+request_shader_reload (RenderThread &render);
+
+// Returns once the renderer let go of its snapshots.
+void
+park_render_thread (RenderThread &render);
+
+void
+resume_render_thread (RenderThread &render, SnapshotBuffer *snapshots);
+
+#endif // RENDER_THREAD_HPP
@@ -0,0 +1,254 @@
+#include <climits>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include "Utils.hpp"
+#include "Shader.hpp"
+#include "ProgramCache.hpp"
+#include "Renderer.hpp"
+
+// Quad corners per vertex, then the instance record, one per instance.
+static void
+set_up_vertex_array (gluint vertex_array,
+                     gluint quad_buffer,
+                     gluint instance_buffer)
+{
+  glBindVertexArray (vertex_array);
+
+  glBindBuffer (GL_ARRAY_BUFFER, quad_buffer);
+  glVertexAttribPointer (0, 2, GL_FLOAT, GL_FALSE, 0, (void *)0);
+  glEnableVertexAttribArray (0);
+
+  glBindBuffer (GL_ARRAY_BUFFER, instance_buffer);
+  glVertexAttribPointer (1,
+                         4,
+                         GL_HALF_FLOAT,
+                         GL_FALSE,
+                         sizeof (Instance),
+                         (void *)offsetof (Instance, rect));
+  glEnableVertexAttribArray (1);
+  glVertexAttribDivisor (1, 1);
+  glVertexAttribIPointer (2,
+                          4,
+                          GL_UNSIGNED_BYTE,
+                          sizeof (Instance),
+                          (void *)offsetof (Instance, color));
+  glEnableVertexAttribArray (2);
+  glVertexAttribDivisor (2, 1);
+}
+
+static GlBuffer
+create_buffer (size_t size, glenum usage)
+{
+  gluint buffer;
+  glCreateBuffers (1, &buffer);
+  // Zero sized stores are fine by GL, but not by every driver.
+  glNamedBufferData (buffer, size > 0 ? size : 1, NULL, usage);
+
+  return GlBuffer (buffer);
+}
+
+Renderer
+create_renderer (Arena &arena,
+                 Arena &scratch,
+                 uint32_t block_count,
+                 uint32_t ball_capacity)
+{
+  Renderer renderer;
+
+  renderer.quad_buffer = create_buffer (4 * sizeof (Vec2f), GL_STATIC_DRAW);
+
+  {
+    Vec2f quad[4] = { { 0.0, 0.0 },
+                      { 1.0, 0.0 },
+                      { 0.0, 1.0 },
+                      { 1.0, 1.0 } };
+
+    glNamedBufferSubData (renderer.quad_buffer, 0, sizeof (quad), quad);
+  }
+
+  renderer.program = load_program (scratch,
+                                   embedded_shader ("quad.vert"),
+                                   embedded_shader ("quad.frag"));
+
+  // Built in, so this is a bug rather than something to recover from.
+  if (renderer.program == 0)
+    std::exit (EXIT_FAILURE);
+
+  renderer.instances = create_instance_stream (arena, 1 + ball_capacity);
+  renderer.base_instance = 0;
+
+  renderer.block_count = block_count;
+  renderer.blocks =
+    create_buffer (block_count * sizeof (Instance), GL_DYNAMIC_DRAW);
+  renderer.alive = create_buffer ((block_count + 31) / 32 * sizeof (uint32_t),
+                                  GL_DYNAMIC_DRAW);
+
+  if (GLEW_VERSION_4_3)
+    {
+      renderer.cull_program =
+        load_compute_program (scratch, embedded_shader ("cull.comp"));
+
+      if (renderer.cull_program == 0)
+        std::exit (EXIT_FAILURE);
+
+      renderer.visible_blocks =
+        create_buffer (block_count * sizeof (Instance), GL_DYNAMIC_COPY);
+      renderer.draw_command =
+        create_buffer (4 * sizeof (gluint), GL_DYNAMIC_COPY);
+
+      // glDrawArraysIndirect arguments: the quad's 4 vertices, as many
+      // instances as the cull pass counts.
+      gluint const command[4] = { 4, 0, 0, 0 };
+
+      glNamedBufferSubData (renderer.draw_command,
+                            0,
+                            sizeof (command),
+                            command);
+    }
+
+  {
+    gluint vertex_arrays[2];
+    glCreateVertexArrays (2, vertex_arrays);
+    renderer.vertex_array = GlVertexArray (vertex_arrays[0]);
+    renderer.block_array = GlVertexArray (vertex_arrays[1]);
+  }
+
+  set_up_vertex_array (renderer.vertex_array,
+                       renderer.quad_buffer,
+                       renderer.instances.buffer);
+  set_up_vertex_array (renderer.block_array,
+                       renderer.quad_buffer,
+                       renderer.cull_program != 0
+                       ? renderer.visible_blocks
+                       : renderer.blocks);
+
+  return renderer;
+}
+
+void
+reload_program (Renderer &renderer, Arena &scratch, const char *directory)
+{
+  ArenaScope scope (scratch);
+  const char *const names[2] = { "quad.vert", "quad.frag" };
+  const char *sources[2];
+
+  for (size_t i = 0; i < 2; i++)
+    {
+      char path[PATH_MAX];
+
+      std::snprintf (path, sizeof (path), "%s/%s", directory, names[i]);
+      sources[i] = try_read_whole_file (scratch, path, NULL);
+
+      // Some editors briefly leave the file missing or empty while
+      // saving. The next write triggers another reload.
+      if (sources[i] == NULL || sources[i][0] == '\0')
+        return;
+    }
+
+  GlShader const vertex_shader =
+    create_shader (scratch, GL_VERTEX_SHADER, sources[0]);
+  GlShader const fragment_shader =
+    create_shader (scratch, GL_FRAGMENT_SHADER, sources[1]);
+  GlProgram program =
+    create_program (scratch, vertex_shader, fragment_shader);
+
+  if (program == 0)
+    return;
+
+  renderer.program = std::move (program);
+  std::fprintf (stderr, "INFO: reloaded shaders from \'%s\'.\n", directory);
+}
+
+void
+upload (Renderer &renderer,
+        const FrameSnapshot &snapshot,
+        bool is_new,
+        float alpha)
+{
+  InstanceStream &stream = renderer.instances;
+
+  stream.shadow[0] =
+    pack_instance (lerp (snapshot.prev_slab, snapshot.slab, alpha),
+                   SLAB_COLOR,
+                   1);
+
+  for (size_t i = 0; i < snapshot.ball_count; i++)
+    stream.shadow[1 + i] =
+      pack_instance (lerp (snapshot.prev_balls[i], snapshot.balls[i], alpha),
+                     BALL_COLOR,
+                     1);
+
+  stream_dirty (stream, 0, 1 + snapshot.ball_count);
+  renderer.base_instance = flush (stream, 1 + snapshot.ball_count);
+
+  // Blocks stay put in the buffers, only hits change them.
+  for (size_t i = 0; is_new && i < snapshot.changed.count; i++)
+    {
+      uint32_t const first = snapshot.changed.ranges[i].first;
+      uint32_t const last = first + snapshot.changed.ranges[i].count;
+      uint32_t const first_word = first / 32, last_word = (last + 31) / 32;
+
+      if (first == last)
+        continue;
+
+      glNamedBufferSubData (renderer.blocks,
+                            first * sizeof (Instance),
+                            (last - first) * sizeof (Instance),
+                            snapshot.blocks + first);
+      glNamedBufferSubData (renderer.alive,
+                            first_word * sizeof (uint32_t),
+                            (last_word - first_word) * sizeof (uint32_t),
+                            snapshot.alive + first_word);
+    }
+}
+
+void
+draw (Renderer &renderer, const FrameSnapshot &snapshot)
+{
+  if (renderer.cull_program != 0)
+    {
+      // Zeroes the instance count on the GPU, in order with the last
+      // frame's draw, where uploading it would wait for that draw.
+      glClearNamedBufferSubData (renderer.draw_command,
+                                 GL_R32UI,
+                                 sizeof (gluint),
+                                 sizeof (gluint),
+                                 GL_RED_INTEGER,
+                                 GL_UNSIGNED_INT,
+                                 NULL);
+
+      glUseProgram (renderer.cull_program);
+      glUniform1ui (0, renderer.block_count);
+      glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 0, renderer.blocks);
+      glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 1, renderer.alive);
+      glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 2, renderer.visible_blocks);
+      glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 3, renderer.draw_command);
+      glDispatchCompute ((renderer.block_count + 63) / 64, 1, 1);
+      // The next frame's clear of the count comes after the atomics.
+      glMemoryBarrier (GL_COMMAND_BARRIER_BIT
+                       | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT
+                       | GL_BUFFER_UPDATE_BARRIER_BIT);
+    }
+
+  glUseProgram (renderer.program);
+  glBindVertexArray (renderer.block_array);
+
+  if (renderer.cull_program != 0)
+    {
+      glBindBuffer (GL_DRAW_INDIRECT_BUFFER, renderer.draw_command);
+      glDrawArraysIndirect (GL_TRIANGLE_STRIP, (void *)0);
+    }
+  else
+    glDrawArraysInstanced (GL_TRIANGLE_STRIP, 0, 4, renderer.block_count);
+
+  glBindVertexArray (renderer.vertex_array);
+  glDrawArraysInstancedBaseInstance (GL_TRIANGLE_STRIP,
+                                     0,
+                                     4,
+                                     1 + snapshot.ball_count,
+                                     renderer.base_instance);
+  end_frame (renderer.instances);
+}
@@ -0,0 +1,62 @@
+#ifndef RENDERER_HPP
+#define RENDERER_HPP
+
+#include "gl_types.hpp"
+#include "GlObject.hpp"
+#include "Arena.hpp"
+#include "Breakout.hpp"
+#include "FrameSnapshot.hpp"
+#include "InstanceStream.hpp"
+
+struct Renderer
+{
+  GlBuffer quad_buffer;
+  GlProgram program;
+
+  // The slab, then the balls, streamed every frame.
+  GlVertexArray vertex_array;
+  InstanceStream instances;
+  uint32_t base_instance;
+
+  // Every block in store order and the alive mask, as in the snapshots.
+  // Only what changed is uploaded.
+  GlBuffer blocks, alive;
+  uint32_t block_count;
+
+  // With GL 4.3 a compute pass packs the live blocks into
+  // "visible_blocks" and counts them into "draw_command", which the
+  // blocks are drawn by, so drawing costs nothing per dead block and the
+  // CPU never looks at them. Otherwise "cull_program" is null, every
+  // block is drawn from "blocks" and quad.vert drops the dead ones.
+  GlProgram cull_program;
+  GlBuffer visible_blocks, draw_command;
+  GlVertexArray block_array;
+};
+
+// Sized for "block_count" blocks and "ball_capacity" balls, with its CPU
+// side on "arena". A renderer is replaced along with the game, its GL
+// objects go when it does.
+Renderer
+create_renderer (Arena &arena,
+                 Arena &scratch,
+                 uint32_t block_count,
+                 uint32_t ball_capacity);
+
+// Rebuilds the program from "quad.vert" and "quad.frag" in "directory".
+// Keeps the current program if either cannot be read or built.
+void
+reload_program (Renderer &renderer, Arena &scratch, const char *directory);
+
+// Uploads the blocks "snapshot" changed, if it is one the renderer has
+// not seen yet. Slab and balls are always streamed, interpolated by
+// "alpha" between their previous and current tick.
+void
+upload (Renderer &renderer,
+        const FrameSnapshot &snapshot,
+        bool is_new,
+        float alpha);
+
+void
+draw (Renderer &renderer, const FrameSnapshot &snapshot);
+
+#endif // RENDERER_HPP
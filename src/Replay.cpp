@@ -0,0 +1,158 @@
+#include <cstdlib>
+#include <cstring>
+#include "Utils.hpp"
+#include "Replay.hpp"
+
+#define HEADER_SIZE (4 + 4 + 8 + 8 + 8)
+
+static void
+put_le (unsigned char *bytes, uint64_t value, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    bytes[i] = value >> (8 * i);
+}
+
+static uint64_t
+get_le (const unsigned char *bytes, size_t size)
+{
+  uint64_t value = 0;
+
+  for (size_t i = 0; i < size; i++)
+    value |= (uint64_t)bytes[i] << (8 * i);
+
+  return value;
+}
+
+static void
+write_header (ReplayRecorder &recorder, uint64_t tick_count)
+{
+  unsigned char header[HEADER_SIZE];
+
+  std::memcpy (header, "BKRP", 4);
+  put_le (header + 4, REPLAY_VERSION, 4);
+  put_le (header + 8, recorder.seed, 8);
+  put_le (header + 16, tick_count, 8);
+  put_le (header + 24, recorder.event_count, 8);
+
+  std::fseek (recorder.file, 0, SEEK_SET);
+  std::fwrite (header, 1, HEADER_SIZE, recorder.file);
+}
+
+ReplayRecorder
+create_replay_recorder (const char *filepath, uint64_t seed)
+{
+  ReplayRecorder recorder;
+
+  recorder.file = std::fopen (filepath, "wb");
+
+  if (recorder.file == NULL)
+    {
+      std::fprintf (stderr,
+                    "ERROR: failed to open file \'%s\'.\n",
+                    filepath);
+      std::exit (EXIT_FAILURE);
+    }
+
+  recorder.seed = seed;
+  recorder.last_tick = 0;
+  recorder.event_count = 0;
+
+  // Tick and event counts are filled in by "finish_replay".
+  write_header (recorder, 0);
+
+  return recorder;
+}
+
+void
+record_input (ReplayRecorder &recorder, uint64_t tick, Input input)
+{
+  unsigned char bytes[11];
+  size_t size = 0;
+
+  for (uint64_t delta = tick - recorder.last_tick; ; delta >>= 7)
+    {
+      bytes[size++] = (delta & 0x7f) | (delta >= 0x80 ? 0x80 : 0);
+
+      if (delta < 0x80)
+        break;
+    }
+
+  bytes[size++] = input;
+
+  std::fwrite (bytes, 1, size, recorder.file);
+
+  recorder.last_tick = tick;
+  recorder.event_count++;
+}
+
+void
+finish_replay (ReplayRecorder &recorder, uint64_t tick_count)
+{
+  write_header (recorder, tick_count);
+  std::fclose (recorder.file);
+  recorder.file = NULL;
+}
+
+static void
+exit_malformed (const char *filepath)
+{
+  std::fprintf (stderr,
+                "ERROR: \'%s\' is not a valid replay.\n",
+                filepath);
+  std::exit (EXIT_FAILURE);
+}
+
+Replay
+load_replay (Arena &arena, Arena &scratch, const char *filepath)
+{
+  ArenaScope scope (scratch);
+  size_t size = 0;
+  unsigned char *data =
+    (unsigned char *)read_whole_file (scratch, filepath, &size);
+
+  if (size < HEADER_SIZE
+      || std::memcmp (data, "BKRP", 4) != 0
+      || get_le (data + 4, 4) != REPLAY_VERSION)
+    exit_malformed (filepath);
+
+  Replay replay;
+
+  replay.seed = get_le (data + 8, 8);
+  replay.tick_count = get_le (data + 16, 8);
+  replay.event_count = get_le (data + 24, 8);
+
+  // Every event takes at least two bytes.
+  if (replay.event_count > (size - HEADER_SIZE) / 2)
+    exit_malformed (filepath);
+
+  replay.events =
+    (ReplayEvent *)push (arena, replay.event_count * sizeof (ReplayEvent));
+
+  unsigned char const *at = data + HEADER_SIZE;
+  unsigned char const *end = data + size;
+  uint64_t tick = 0;
+
+  for (size_t i = 0; i < replay.event_count; i++)
+    {
+      uint64_t delta = 0;
+
+      for (unsigned shift = 0; ; shift += 7)
+        {
+          if (at == end || shift > 63)
+            exit_malformed (filepath);
+
+          delta |= (uint64_t)(*at & 0x7f) << shift;
+
+          if ((*at++ & 0x80) == 0)
+            break;
+        }
+
+      if (at == end || *at > Input_SpawnBall)
+        exit_malformed (filepath);
+
+      tick += delta;
+      replay.events[i] = { tick, (Input)*at++ };
+    }
+
+  return replay;
+}
@@ -0,0 +1,52 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include "Arena.hpp"
+#include "Breakout.hpp"
+
+// File layout, integers little-endian:
+//   "BKRP", u32 version, u64 seed, u64 tick count, u64 event count,
+//   then per event a LEB128 tick delta from the previous event followed
+//   by one "Input" byte.
+#define REPLAY_VERSION 1
+
+struct ReplayEvent
+{
+  uint64_t tick;
+  Input input;
+};
+
+struct Replay
+{
+  uint64_t seed;
+  uint64_t tick_count;
+  ReplayEvent *events;
+  size_t event_count;
+};
+
+struct ReplayRecorder
+{
+  FILE *file;
+  uint64_t seed;
+  uint64_t last_tick;
+  uint64_t event_count;
+};
+
+ReplayRecorder
+create_replay_recorder (const char *filepath, uint64_t seed);
+
+// "tick" is the number of update() calls the input arrived after.
+void
+record_input (ReplayRecorder &recorder, uint64_t tick, Input input);
+
+void
+finish_replay (ReplayRecorder &recorder, uint64_t tick_count);
+
+// Events live on "arena", "scratch" holds the file while it is parsed.
+Replay
+load_replay (Arena &arena, Arena &scratch, const char *filepath);
+
+#endif // REPLAY_HPP
@@ -0,0 +1,122 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include "Shader.hpp"
+
+struct EmbeddedShader
+{
+  const char *name;
+  const char *source;
+};
+
+// "shaders.inc" is generated by build.sh from the shaders directory.
+static EmbeddedShader const embedded_shaders[] =
+  {
+#include "shaders.inc"
+  };
+
+const char *
+embedded_shader (const char *name)
+{
+  for (auto const &shader : embedded_shaders)
+    if (std::strcmp (shader.name, name) == 0)
+      return shader.source;
+
+  std::fprintf (stderr, "ERROR: no embedded shader \'%s\'.\n", name);
+  std::exit (EXIT_FAILURE);
+}
+
+GlShader
+create_shader (Arena &scratch, glenum shader_type, const char *source)
+{
+  assert (shader_type == GL_VERTEX_SHADER
+          || shader_type == GL_FRAGMENT_SHADER
+          || shader_type == GL_COMPUTE_SHADER);
+
+  ArenaScope scope (scratch);
+  GlShader shader (glCreateShader (shader_type));
+
+  glShaderSource (shader, 1, &source, NULL);
+
+  glint is_ok;
+  glCompileShader (shader);
+  glGetShaderiv (shader, GL_COMPILE_STATUS, &is_ok);
+
+  if (is_ok != GL_TRUE)
+    {
+      glint log_size = 0;
+      glGetShaderiv (shader, GL_INFO_LOG_LENGTH, &log_size);
+      char *error_message = (char *)push (scratch, log_size + 1);
+      glGetShaderInfoLog (shader, log_size, NULL, error_message);
+      error_message[log_size] = '\0';
+      std::fprintf (stderr,
+                    "ERROR: failed to compile %s shader:\n%s",
+                    shader_type == GL_VERTEX_SHADER ? "vertex"
+                    : shader_type == GL_FRAGMENT_SHADER ? "fragment"
+                    : "compute",
+                    error_message);
+      shader.reset ();
+    }
+
+  return shader;
+}
+
+static GlProgram
+link_program (Arena &scratch, const gluint *shaders, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+    if (shaders[i] == 0)
+      return GlProgram ();
+
+  ArenaScope scope (scratch);
+  GlProgram program (glCreateProgram ());
+
+  // Lets the program cache read the binary back.
+  if (GLEW_ARB_get_program_binary)
+    glProgramParameteri (program,
+                         GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                         GL_TRUE);
+
+  glint is_ok;
+
+  for (size_t i = 0; i < count; i++)
+    glAttachShader (program, shaders[i]);
+
+  glLinkProgram (program);
+  glGetProgramiv (program, GL_LINK_STATUS, &is_ok);
+
+  if (is_ok != GL_TRUE)
+    {
+      glint log_size = 0;
+      glGetProgramiv (program, GL_INFO_LOG_LENGTH, &log_size);
+      char *error_message = (char *)push (scratch, log_size + 1);
+      glGetProgramInfoLog (program, log_size, NULL, error_message);
+      error_message[log_size] = '\0';
+      std::fprintf (stderr,
+                    "ERROR: failed to link program:\n%s",
+                    error_message);
+      program.reset ();
+
+      return program;
+    }
+
+  for (size_t i = 0; i < count; i++)
+    glDetachShader (program, shaders[i]);
+
+  return program;
+}
+
+GlProgram
+create_program (Arena &scratch, gluint vertex_shader, gluint fragment_shader)
+{
+  gluint const shaders[2] = { vertex_shader, fragment_shader };
+
+  return link_program (scratch, shaders, 2);
+}
+
+GlProgram
+create_compute_program (Arena &scratch, gluint compute_shader)
+{
+  return link_program (scratch, &compute_shader, 1);
+}
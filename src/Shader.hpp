@@ -0,0 +1,28 @@
+#ifndef SHADER_HPP
+#define SHADER_HPP
+
+#include "gl_types.hpp"
+#include "GlObject.hpp"
+#include "Arena.hpp"
+
+// Source of a shader built into the executable, by its file name in the
+// shaders directory, e.g. "quad.vert".
+const char *
+embedded_shader (const char *name);
+
+// Logs go through "scratch", which is left as it was found. Failures
+// print the log and return the null handle.
+GlShader
+create_shader (Arena &scratch, glenum shader_type, const char *source);
+
+// Null if either shader is.
+GlProgram
+create_program (Arena &scratch,
+                gluint vertex_shader,
+                gluint fragment_shader);
+
+// Null if the shader is.
+GlProgram
+create_compute_program (Arena &scratch, gluint compute_shader);
+
+#endif // SHADER_HPP
@@ -0,0 +1,57 @@
+#include <cstdio>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "ShaderWatcher.hpp"
+
+ShaderWatcher
+create_shader_watcher (const char *directory)
+{
+  ShaderWatcher watcher;
+
+  watcher.directory = directory;
+  watcher.fd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+
+  // Editors either rewrite a file in place or write a new one and
+  // rename it over the old.
+  if (watcher.fd != -1
+      && inotify_add_watch (watcher.fd,
+                            directory,
+                            IN_CLOSE_WRITE | IN_MOVED_TO) == -1)
+    {
+      ::close (watcher.fd);
+      watcher.fd = -1;
+    }
+
+  if (watcher.fd == -1)
+    std::fprintf (stderr,
+                  "WARNING: cannot watch \'%s\' for shader changes.\n",
+                  directory);
+
+  return watcher;
+}
+
+void
+destroy_shader_watcher (ShaderWatcher &watcher)
+{
+  if (watcher.fd != -1)
+    ::close (watcher.fd);
+
+  watcher.fd = -1;
+}
+
+bool
+shaders_changed (ShaderWatcher &watcher)
+{
+  alignas (inotify_event) char events[4096];
+  bool changed = false;
+
+  if (watcher.fd == -1)
+    return false;
+
+  // Saving one file can raise several events, all of them answered by
+  // a single rebuild.
+  while (read (watcher.fd, events, sizeof (events)) > 0)
+    changed = true;
+
+  return changed;
+}
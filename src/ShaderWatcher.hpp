@@ -0,0 +1,24 @@
+#ifndef SHADER_WATCHER_HPP
+#define SHADER_WATCHER_HPP
+
+// Watches a directory of shaders through inotify. Nothing happens until
+// the descriptor becomes readable, so checking it costs one poll.
+struct ShaderWatcher
+{
+  int fd;
+  const char *directory;
+};
+
+// "fd" is -1 if the directory cannot be watched.
+ShaderWatcher
+create_shader_watcher (const char *directory);
+
+void
+destroy_shader_watcher (ShaderWatcher &watcher);
+
+// Consumes every pending event, true if any file in the directory was
+// rewritten or replaced since the last call. Never blocks.
+bool
+shaders_changed (ShaderWatcher &watcher);
+
+#endif // SHADER_WATCHER_HPP
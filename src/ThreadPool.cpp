@@ -0,0 +1,145 @@
+#include "ThreadPool.hpp"
+
+static void
+run_share (ThreadPool &pool, size_t worker)
+{
+  for (size_t i = 0; i < pool.thread_count; i++)
+    {
+      WorkRange &range = pool.ranges[(worker + i) % pool.thread_count];
+
+      for (;;)
+        {
+          size_t const first =
+            range.next.fetch_add (pool.grain, std::memory_order_relaxed);
+
+          if (first >= range.end)
+            break;
+
+          size_t const last =
+            range.end - first < pool.grain ? range.end : first + pool.grain;
+
+          pool.task (first, last, pool.context);
+        }
+    }
+}
+
+static void
+worker_main (ThreadPool *pool, size_t worker)
+{
+  uint64_t seen = 0;
+
+  for (;;)
+    {
+      {
+        std::unique_lock<std::mutex> lock (pool->mutex);
+
+        pool->wake.wait (lock,
+                         [pool, seen]
+                         {
+                           return pool->stopping
+                             || pool->generation != seen;
+                         });
+
+        if (pool->stopping)
+          return;
+
+        seen = pool->generation;
+      }
+
+      run_share (*pool, worker);
+
+      {
+        std::lock_guard<std::mutex> lock (pool->mutex);
+
+        if (--pool->busy == 0)
+          pool->done.notify_one ();
+      }
+    }
+}
+
+ThreadPool *
+create_thread_pool (size_t thread_count)
+{
+  if (thread_count == 0)
+    thread_count = std::thread::hardware_concurrency ();
+  if (thread_count == 0)
+    thread_count = 1;
+
+  ThreadPool *pool = new ThreadPool;
+
+  pool->thread_count = thread_count;
+  pool->ranges = new WorkRange[thread_count];
+  pool->generation = 0;
+  pool->busy = 0;
+  pool->stopping = false;
+
+  for (size_t i = 0; i < thread_count; i++)
+    {
+      pool->ranges[i].next = 0;
+      pool->ranges[i].end = 0;
+    }
+
+  pool->threads = new std::thread[thread_count - 1];
+
+  for (size_t i = 1; i < thread_count; i++)
+    pool->threads[i - 1] = std::thread (worker_main, pool, i);
+
+  return pool;
+}
+
+void
+destroy_thread_pool (ThreadPool *pool)
+{
+  {
+    std::lock_guard<std::mutex> lock (pool->mutex);
+    pool->stopping = true;
+  }
+
+  pool->wake.notify_all ();
+
+  for (size_t i = 1; i < pool->thread_count; i++)
+    pool->threads[i - 1].join ();
+
+  delete[] pool->threads;
+  delete[] pool->ranges;
+  delete pool;
+}
+
+void
+parallel_for (ThreadPool &pool,
+              size_t count,
+              size_t grain,
+              RangeTask task,
+              void *context)
+{
+  size_t const threads = pool.thread_count;
+
+  pool.task = task;
+  pool.context = context;
+  pool.grain = grain == 0 ? 1 : grain;
+
+  for (size_t i = 0; i < threads; i++)
+    {
+      pool.ranges[i].next.store (count * i / threads,
+                                 std::memory_order_relaxed);
+      pool.ranges[i].end = count * (i + 1) / threads;
+    }
+
+  if (threads == 1)
+    {
+      run_share (pool, 0);
+      return;
+    }
+
+  {
+    std::lock_guard<std::mutex> lock (pool.mutex);
+    pool.busy = threads - 1;
+    pool.generation++;
+  }
+
+  pool.wake.notify_all ();
+  run_share (pool, 0);
+
+  std::unique_lock<std::mutex> lock (pool.mutex);
+  pool.done.wait (lock, [&pool] { return pool.busy == 0; });
+}
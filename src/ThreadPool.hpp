@@ -0,0 +1,61 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Processes items "[first, last[". "context" is passed through, like with
+// the window callbacks.
+typedef void (*RangeTask)(size_t first, size_t last, void *context);
+
+// One worker's share of a "parallel_for". The owner and thieves alike
+// claim "grain" items at a time from "next", so stealing needs no locks.
+// Padded to a cache line to keep workers from sharing one.
+struct WorkRange
+{
+  std::atomic<size_t> next;
+  size_t end;
+  char padding[64 - sizeof (std::atomic<size_t>) - sizeof (size_t)];
+};
+
+struct ThreadPool
+{
+  // Including the thread that calls "parallel_for".
+  size_t thread_count;
+  std::thread *threads;
+  WorkRange *ranges;
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  uint64_t generation;
+  size_t busy;
+  bool stopping;
+
+  RangeTask task;
+  void *context;
+  size_t grain;
+};
+
+// "thread_count == 0" uses one thread per core.
+ThreadPool *
+create_thread_pool (size_t thread_count);
+
+void
+destroy_thread_pool (ThreadPool *pool);
+
+// Runs "task" over "[0, count[" on all threads and returns once every
+// item is done. Each thread starts on its own contiguous share and steals
+// from the others when it runs out.
+void
+parallel_for (ThreadPool &pool,
+              size_t count,
+              size_t grain,
+              RangeTask task,
+              void *context);
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,102 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include "Timing.hpp"
+
+uint64_t
+now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+FixedTimestep
+create_fixed_timestep (uint32_t ticks_per_second)
+{
+  FixedTimestep timestep;
+
+  timestep.tick_ns = 1000000000 / ticks_per_second;
+  // A frame that took longer than this (breakpoint, suspended process)
+  // is not worth catching up on tick by tick.
+  timestep.max_frame_ns = 250000000;
+  timestep.accumulator = 0;
+  timestep.last_time = now_ns ();
+
+  return timestep;
+}
+
+uint32_t
+advance (FixedTimestep &timestep)
+{
+  uint64_t const time = now_ns ();
+  uint64_t elapsed = time - timestep.last_time;
+
+  timestep.last_time = time;
+
+  if (elapsed > timestep.max_frame_ns)
+    elapsed = timestep.max_frame_ns;
+
+  timestep.accumulator += elapsed;
+
+  uint32_t const ticks = timestep.accumulator / timestep.tick_ns;
+  timestep.accumulator -= ticks * timestep.tick_ns;
+
+  return ticks;
+}
+
+uint64_t
+tick_end_time (const FixedTimestep &timestep, uint32_t ticks_left)
+{
+  return (timestep.last_time - timestep.accumulator
+          - (uint64_t)(ticks_left - 1) * timestep.tick_ns);
+}
+
+uint64_t
+next_tick_time (const FixedTimestep &timestep)
+{
+  return timestep.last_time - timestep.accumulator + timestep.tick_ns;
+}
+
+float
+interpolation_alpha (uint64_t tick_end, uint64_t tick_ns, uint64_t time)
+{
+  if (time <= tick_end)
+    return 0;
+
+  // The simulation fell behind, hold the last tick rather than
+  // extrapolate.
+  if (time - tick_end >= tick_ns)
+    return 1;
+
+  return (float)(time - tick_end) / tick_ns;
+}
+
+void
+sleep_until (uint64_t time)
+{
+  struct timespec ts;
+
+  ts.tv_sec = time / 1000000000;
+  ts.tv_nsec = time % 1000000000;
+
+  int error;
+
+  // Signals cut the sleep short, the absolute deadline stays the same.
+  while ((error = clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL))
+         == EINTR)
+    {
+    }
+
+  if (error != 0)
+    {
+      std::fprintf (stderr,
+                    "ERROR: failed to sleep: %s.\n",
+                    std::strerror (error));
+      std::exit (EXIT_FAILURE);
+    }
+}
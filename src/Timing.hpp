@@ -0,0 +1,46 @@
+#ifndef TIMING_HPP
+#define TIMING_HPP
+
+#include <cstdint>
+
+// Nanoseconds on the monotonic clock. Only differences are meaningful.
+uint64_t
+now_ns (void);
+
+// Accumulator scheduler: real time is banked every frame and spent in
+// "tick_ns" sized simulation steps, so the simulation advances the same
+// amount per second whatever the frame rate.
+struct FixedTimestep
+{
+  uint64_t tick_ns;
+  uint64_t max_frame_ns;
+  uint64_t accumulator;
+  uint64_t last_time;
+};
+
+FixedTimestep
+create_fixed_timestep (uint32_t ticks_per_second);
+
+// Returns how many ticks to simulate this frame.
+uint32_t
+advance (FixedTimestep &timestep);
+
+// Real time up to which the tick "ticks_left" from the end of this
+// frame's ticks simulates, "ticks_left == 1" being the last one.
+uint64_t
+tick_end_time (const FixedTimestep &timestep, uint32_t ticks_left);
+
+// Real time the next tick simulates up to.
+uint64_t
+next_tick_time (const FixedTimestep &timestep);
+
+// How far, in "[0, 1]", "time" is into the tick after the one that
+// simulated up to "tick_end".
+float
+interpolation_alpha (uint64_t tick_end, uint64_t tick_ns, uint64_t time);
+
+// Sleeps until "now_ns () >= time".
+void
+sleep_until (uint64_t time);
+
+#endif // TIMING_HPP
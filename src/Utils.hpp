@@ -2,18 +2,47 @@
 #define UTILS_HPP
 
 #include <cstddef>
-#include "gl_types.hpp"
+#include <cstdint>
+#include "Arena.hpp"
+
+#define FNV1A_OFFSET_BASIS 0xcbf29ce484222325
+
+// Binary levels and saved states store this as a "uint32_t" to reject
+// files written on other byte orders.
+#define BYTE_ORDER_MARK 0x01020304
+
+// Offsets of arrays in binary files, so they can be used in place.
+inline size_t
+align8 (size_t offset)
+{
+  return (offset + 7) / 8 * 8;
+}
 
 void *
 malloc_or_exit (size_t size);
 
-char *
-read_whole_file (const char *filepath, size_t *file_size_loc);
+// Calls to "malloc_or_exit" and "create_arena" so far, plus whatever
+// else reports itself through "track_allocation", to check that code
+// meant to run out of arenas allocates nothing. Plain malloc and the
+// allocations libc makes on its own, in fopen for one, are not seen.
+size_t
+tracked_allocation_count (void);
 
-gluint
-create_shader (glenum shader_type, const char *filepath);
+void
+track_allocation (void);
 
-gluint
-create_program (gluint vertex_shader, gluint fragment_shader);
+// Folds "size" bytes into "hash". Start from FNV1A_OFFSET_BASIS.
+uint64_t
+fnv1a (uint64_t hash, const void *data, size_t size);
+
+// Null terminated, on top of "arena". NULL if the file cannot be read.
+char *
+try_read_whole_file (Arena &arena,
+                     const char *filepath,
+                     size_t *file_size_loc);
+
+// Exits if the file cannot be read.
+char *
+read_whole_file (Arena &arena, const char *filepath, size_t *file_size_loc);
 
 #endif // UTILS_HPP
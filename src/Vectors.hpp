@@ -1,27 +1,130 @@
 #ifndef VECTORS_HPP
 #define VECTORS_HPP
 
+#include <cmath>
+
+// Everything here is inline, and "constexpr" where C++11 allows it, so
+// that the collision code compiles down to straight-line arithmetic.
+
 struct Vec2f
 {
   float x, y;
 };
 
-Vec2f &
-operator+= (Vec2f &x, const Vec2f &y);
+inline Vec2f &
+operator+= (Vec2f &x, const Vec2f &y)
+{
+  x.x += y.x;
+  x.y += y.y;
+
+  return x;
+}
+
+inline Vec2f &
+operator-= (Vec2f &x, const Vec2f &y)
+{
+  x.x -= y.x;
+  x.y -= y.y;
+
+  return x;
+}
+
+inline Vec2f &
+operator*= (Vec2f &x, float scalar)
+{
+  x.x *= scalar;
+  x.y *= scalar;
+
+  return x;
+}
+
+constexpr Vec2f
+operator- (const Vec2f &x)
+{
+  return { -x.x, -x.y };
+}
+
+constexpr Vec2f
+operator+ (const Vec2f &x, const Vec2f &y)
+{
+  return { x.x + y.x, x.y + y.y };
+}
+
+constexpr Vec2f
+operator- (const Vec2f &x, const Vec2f &y)
+{
+  return { x.x - y.x, x.y - y.y };
+}
+
+// Component-wise product.
+constexpr Vec2f
+operator* (const Vec2f &x, const Vec2f &y)
+{
+  return { x.x * y.x, x.y * y.y };
+}
 
-Vec2f &
-operator-= (Vec2f &x, const Vec2f &y);
+constexpr Vec2f
+operator* (const Vec2f &x, float scalar)
+{
+  return { x.x * scalar, x.y * scalar };
+}
 
-Vec2f
-operator+ (const Vec2f &x, const Vec2f &y);
+constexpr Vec2f
+operator* (float scalar, const Vec2f &x)
+{
+  return { x.x * scalar, x.y * scalar };
+}
 
-Vec2f
-operator- (const Vec2f &x, const Vec2f &y);
+constexpr Vec2f
+operator/ (const Vec2f &x, float scalar)
+{
+  return { x.x / scalar, x.y / scalar };
+}
 
-Vec2f
-operator* (const Vec2f &x, float scalar);
+constexpr float
+dot (const Vec2f &x, const Vec2f &y)
+{
+  return x.x * y.x + x.y * y.y;
+}
+
+constexpr float
+cross (const Vec2f &x, const Vec2f &y)
+{
+  return x.x * y.y - x.y * y.x;
+}
+
+// Component-wise minimum and maximum.
+constexpr Vec2f
+min (const Vec2f &x, const Vec2f &y)
+{
+  return { y.x < x.x ? y.x : x.x, y.y < x.y ? y.y : x.y };
+}
+
+constexpr Vec2f
+max (const Vec2f &x, const Vec2f &y)
+{
+  return { x.x < y.x ? y.x : x.x, x.y < y.y ? y.y : x.y };
+}
+
+constexpr Vec2f
+clamp (const Vec2f &x, const Vec2f &low, const Vec2f &high)
+{
+  return min (max (x, low), high);
+}
+
+inline float
+length (const Vec2f &x)
+{
+  return std::sqrt (dot (x, x));
+}
+
+// The zero vector is returned unchanged.
+inline Vec2f
+normalize (const Vec2f &x)
+{
+  float const len = length (x);
 
-float
-cross (const Vec2f &x, const Vec2f &y);
+  return len == 0 ? x : x / len;
+}
 
 #endif // VECTORS_HPP
@@ -1,24 +1,23 @@
 #include <cstdio>
 #include <cstdlib>
+#include <poll.h>
+#include "Timing.hpp"
 #include "X11Window.hpp"
 
-KeyboardCallback keyboard_callback = NULL;
 MouseCallback mouse_callback = NULL;
+WatchCallback watch_callback = NULL;
+
+int watch_fd = -1;
 
-void *keyboard_context = NULL;
 void *mouse_context = NULL;
+void *watch_context = NULL;
 
-time_t when_window_was_created = 0;
+uint64_t when_window_was_created = 0;
 
 time_t
 gettime ()
 {
-  struct timespec ts;
-
-  clock_gettime (CLOCK_MONOTONIC, &ts);
-
-  return (ts.tv_sec - when_window_was_created) * 1000
-    + ts.tv_nsec / 100000;
+  return (now_ns () - when_window_was_created) / 1000000;
 }
 
 X11Window
@@ -28,6 +27,10 @@ create_x11_window (uint32_t width,
 {
   X11Window window;
 
+  // The render thread swaps on this connection while the main thread
+  // reads events from it.
+  XInitThreads ();
+
   window.should_close = false;
   window.display = XOpenDisplay ((char *)0);
 
@@ -61,8 +64,9 @@ create_x11_window (uint32_t width,
                                                 root,
                                                 visual->visual,
                                                 AllocNone);
-  window_attributes.event_mask =
-    KeyPressMask | KeyReleaseMask | ButtonPressMask;
+  // The keyboard is read by the input thread, over a connection of its
+  // own.
+  window_attributes.event_mask = ButtonPressMask;
   window.handle = XCreateWindow (window.display,
                                  root,
                                  0,
@@ -105,7 +109,7 @@ create_x11_window (uint32_t width,
                    &window.wm_delete_message,
                    1);
 
-  when_window_was_created = gettime () / 1000;
+  when_window_was_created = now_ns ();
 
   return window;
 }
@@ -121,11 +125,6 @@ close (X11Window &window)
 void
 process_events (X11Window &window)
 {
-  static bool was_a_pressed = false;
-  static bool was_d_pressed = false;
-
-  bool should_repeat = true;
-
   int pending = XPending (window.display);
 
   while (pending-- > 0)
@@ -135,49 +134,6 @@ process_events (X11Window &window)
 
       switch (xevent.type)
         {
-        case KeyPress:
-          {
-            KeySym key = XLookupKeysym (&xevent.xkey, 0);
-
-            if (key == XK_a)
-              {
-                was_a_pressed = true;
-                should_repeat = false;
-              }
-            else if (key == XK_d)
-              {
-                was_d_pressed = true;
-                should_repeat = false;
-              }
-
-            if (keyboard_callback != NULL)
-              keyboard_callback (window, key, keyboard_context);
-          }
-
-          break;
-        case KeyRelease:
-          {
-            if (XEventsQueued (window.display, QueuedAfterReading) > 0)
-              {
-                XEvent next;
-                XPeekEvent (window.display, &next);
-
-                if (next.type == KeyPress
-                    && next.xkey.window == xevent.xkey.window
-                    && next.xkey.keycode == xevent.xkey.keycode
-                    && next.xkey.time == xevent.xkey.time)
-                  continue;
-              }
-
-            KeySym key = XLookupKeysym (&xevent.xkey, 0);
-
-            if (key == XK_a)
-              was_a_pressed = false;
-            else if (key == XK_d)
-              was_d_pressed = false;
-          }
-
-          break;
         case ButtonPress:
           if (mouse_callback != NULL)
             mouse_callback (window, xevent.xbutton, mouse_context);
@@ -189,11 +145,17 @@ process_events (X11Window &window)
         }
     }
 
-  if (should_repeat && (was_a_pressed || was_d_pressed))
+  if (watch_callback != NULL && watch_fd != -1)
     {
-      if (keyboard_callback != NULL)
-        keyboard_callback (window,
-                           was_a_pressed ? XK_a : XK_d,
-                           keyboard_context);
+      pollfd watched = { watch_fd, POLLIN, 0 };
+
+      if (poll (&watched, 1, 0) > 0 && (watched.revents & POLLIN) != 0)
+        watch_callback (window, watch_fd, watch_context);
     }
 }
+
+void
+swap_buffers (X11Window &window)
+{
+  glXSwapBuffers (window.display, window.handle);
+}
@@ -1,6 +1,7 @@
 #ifndef X11WINDOW_HPP
 #define X11WINDOW_HPP
 
+#include <ctime>
 #include <functional>
 #include <X11/Xlib.h>
 #include <GL/glx.h>
@@ -18,19 +19,22 @@ struct X11Window
 
 // "context" is used to pass additional information to the callback.
 // Effectively it's std::function<...> implemented in C style.
-typedef void (*KeyboardCallback)(X11Window &window,
-                                 KeySym keysym,
-                                 void *context);
 typedef void (*MouseCallback)(X11Window &window,
                               XButtonEvent &event,
                               void *context);
+// Called when "watch_fd" has something to read.
+typedef void (*WatchCallback)(X11Window &window, int fd, void *context);
 
-extern KeyboardCallback keyboard_callback;
 extern MouseCallback mouse_callback;
+extern WatchCallback watch_callback;
+
+// Polled without blocking once per process_events(). -1 to disable.
+extern int watch_fd;
 
-extern void *keyboard_context;
 extern void *mouse_conntext;
+extern void *watch_context;
 
+// Milliseconds since the window was created.
 time_t
 gettime ();
 
@@ -45,4 +49,8 @@ close (X11Window &window);
 void
 process_events (X11Window &window);
 
+// Shows the frame drawn since the last swap.
+void
+swap_buffers (X11Window &window);
+
 #endif // X11WINDOW_HPP
@@ -0,0 +1,83 @@
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "BreakoutBatch.hpp"
+#include "Timing.hpp"
+#include "Utils.hpp"
+
+// Steps a batch of games with 1, 2, 4, ... threads up to one per core and
+// reports aggregate steps per second and the speedup over one thread.
+int
+main (int argc, char **argv)
+{
+  if (argc > 3)
+    {
+      std::fprintf (stderr, "usage: %s [GAMES] [TICKS]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  size_t const game_count = argc > 1 ? std::atol (argv[1]) : 4096;
+  size_t const tick_count = argc > 2 ? std::atol (argv[2]) : 1000;
+
+  size_t max_threads = std::thread::hardware_concurrency ();
+  if (max_threads == 0)
+    max_threads = 1;
+
+  Action *actions =
+    (Action *)malloc_or_exit (game_count * sizeof (Action));
+  float *observations =
+    (float *)malloc_or_exit (game_count * OBSERVATION_SIZE
+                             * sizeof (float));
+
+  std::printf ("games: %zu, ticks: %zu\n", game_count, tick_count);
+  std::printf ("%8s %16s %8s\n", "threads", "steps/s", "speedup");
+
+  double single_thread = 0;
+
+  for (size_t threads = 1; ; threads *= 2)
+    {
+      if (threads > max_threads)
+        threads = max_threads;
+
+      ThreadPool *pool = create_thread_pool (threads);
+      BreakoutBatch batch = create_breakout_batch (game_count, 1);
+
+      uint64_t const start = now_ns ();
+
+      for (size_t tick = 0; tick < tick_count; tick++)
+        {
+          // Cheap deterministic policy: chase the ball.
+          for (size_t i = 0; i < game_count; i++)
+            {
+              float const *observation =
+                observations + i * OBSERVATION_SIZE;
+
+              actions[i] = (tick == 0 ? Action_None
+                            : observation[1] < observation[0]
+                            ? Action_Left : Action_Right);
+            }
+
+          step (batch, *pool, actions, observations);
+        }
+
+      double const seconds = (now_ns () - start) / 1e9;
+      double const steps_per_second = game_count * tick_count / seconds;
+
+      if (threads == 1)
+        single_thread = steps_per_second;
+
+      std::printf ("%8zu %16.0f %8.2f\n",
+                   threads, steps_per_second,
+                   steps_per_second / single_thread);
+
+      destroy_breakout_batch (batch);
+      destroy_thread_pool (pool);
+
+      if (threads == max_threads)
+        break;
+    }
+
+  std::free (observations);
+  std::free (actions);
+}
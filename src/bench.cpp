@@ -0,0 +1,223 @@
+#include <cstdlib>
+#include <algorithm>
+#include "Arena.hpp"
+#include "Utils.hpp"
+#include "Breakout.hpp"
+#include "GameState.hpp"
+#include "Timing.hpp"
+#include "Bench.hpp"
+
+// Microbenchmarks of the simulation hot paths, which need nothing but the
+// simulation. "breakout-upload-bench" has those of the uploads.
+
+// Results land here so no work is optimized away.
+static volatile uint64_t sink;
+
+static size_t
+rounds_for (size_t bricks)
+{
+  return std::max ((size_t)MIN_OPS_PER_REPETITION / bricks, (size_t)1);
+}
+
+// A ball among the bricks of the larger walls, below those of the
+// smaller ones, moving up and right.
+static AABB const probe = { { 0.1, 0.3 }, { 0.05, 0.05 } };
+static Vec2f const probe_vel = { 0.007, 0.01 };
+
+static void
+bench_kernels (Bench &bench, const Level &level)
+{
+  BlockStore const &blocks = level.blocks;
+  size_t const count = blocks.count;
+  size_t const rounds = rounds_for (count);
+  AABB *boxes = (AABB *)malloc_or_exit (count * sizeof (AABB));
+  uint32_t *hits = (uint32_t *)malloc_or_exit (count * sizeof (uint32_t));
+
+  for (size_t i = 0; i < count; i++)
+    boxes[i] = get_block (blocks, i);
+
+  // A wide strip across the top rows, overlapping bricks at every size.
+  // Tested against every brick, so the numbers scale with the level
+  // rather than with how lucky a grid lookup is.
+  AABB area = probe;
+
+  area.pos.x -= 0.5;
+  area.shape.x += 1;
+  area.pos.y += 0.5;
+
+  measure (bench, "do_intersect", count, rounds * count,
+           [&]()
+           {
+             uint64_t const start = now_ns ();
+             uint64_t hit_count = 0;
+
+             for (size_t r = 0; r < rounds; r++)
+               for (size_t i = 0; i < count; i++)
+                 hit_count += do_intersect (area, boxes[i]);
+
+             sink = hit_count;
+
+             return now_ns () - start;
+           });
+
+  measure (bench, "hit_direction", count, rounds * count,
+           [&]()
+           {
+             uint64_t const start = now_ns ();
+             uint64_t directions = 0;
+
+             for (size_t r = 0; r < rounds; r++)
+               for (size_t i = 0; i < count; i++)
+                 directions += hit_direction (boxes[i], probe, probe_vel);
+
+             sink = directions;
+
+             return now_ns () - start;
+           });
+
+  measure (bench, "sweep", count, rounds * count,
+           [&]()
+           {
+             uint64_t const start = now_ns ();
+             uint64_t contacts = 0;
+             Contact contact;
+
+             for (size_t r = 0; r < rounds; r++)
+               for (size_t i = 0; i < count; i++)
+                 contacts += sweep (probe, probe_vel, boxes[i], &contact);
+
+             sink = contacts;
+
+             return now_ns () - start;
+           });
+
+  measure (bench, "find_overlapping", count, rounds * count,
+           [&]()
+           {
+             uint64_t const start = now_ns ();
+             uint64_t hit_count = 0;
+
+             for (size_t r = 0; r < rounds; r++)
+               hit_count += find_overlapping (blocks, area, 0, count, hits);
+
+             sink = hit_count;
+
+             return now_ns () - start;
+           });
+
+  measure (bench, "find_overlapping_scalar", count, rounds * count,
+           [&]()
+           {
+             uint64_t const start = now_ns ();
+             uint64_t hit_count = 0;
+
+             for (size_t r = 0; r < rounds; r++)
+               hit_count +=
+                 find_overlapping_scalar (blocks, area, 0, count, hits);
+
+             sink = hit_count;
+
+             return now_ns () - start;
+           });
+
+  std::free (hits);
+  std::free (boxes);
+}
+
+#define UPDATE_TICKS 1000
+
+// Whole ticks from a fresh game every repetition, since balls wear the
+// wall down. Building the level is not timed.
+static void
+bench_update (Bench &bench,
+              Arena &level_arena,
+              Arena &scratch,
+              size_t bricks,
+              const char *name,
+              size_t ball_count)
+{
+  measure (bench, name, bricks, UPDATE_TICKS,
+           [&]()
+           {
+             reset_arena (level_arena);
+
+             Breakout game =
+               create_breakout (level_arena,
+                                wall_level (level_arena, scratch, bricks),
+                                1,
+                                ball_count);
+
+             while (game.ball_count < ball_count)
+               handle_input (game, Input_SpawnBall);
+
+             uint64_t const start = now_ns ();
+
+             for (size_t i = 0; i < UPDATE_TICKS; i++)
+               update (game);
+
+             uint64_t const elapsed = now_ns () - start;
+
+             sink = hash_state (game);
+
+             return elapsed;
+           });
+}
+
+#define ROUND_TRIPS 1000
+
+// Saving and restoring a game some way into play, with 64 balls.
+static void
+bench_game_state (Bench &bench,
+                  Arena &level_arena,
+                  Arena &scratch,
+                  size_t bricks)
+{
+  reset_arena (level_arena);
+
+  Breakout game =
+    create_breakout (level_arena,
+                     wall_level (level_arena, scratch, bricks),
+                     1,
+                     64);
+
+  while (game.ball_count < 64)
+    handle_input (game, Input_SpawnBall);
+
+  for (size_t i = 0; i < UPDATE_TICKS; i++)
+    update (game);
+
+  void *state = push (level_arena, game_state_size (game));
+
+  measure (bench, "game_state_round_trip", bricks, ROUND_TRIPS,
+           [&]()
+           {
+             uint64_t const start = now_ns ();
+
+             for (size_t i = 0; i < ROUND_TRIPS; i++)
+               restore_game_state (game,
+                                   state,
+                                   save_game_state (game, state));
+
+             return now_ns () - start;
+           });
+}
+
+int
+main (int argc, char **argv)
+{
+  Bench bench = create_bench (argc, argv);
+  Arena level_arena = create_arena (LEVEL_ARENA_SIZE);
+  Arena scratch = create_arena (SCRATCH_ARENA_SIZE);
+
+  for (size_t bricks : bench_brick_counts)
+    {
+      reset_arena (level_arena);
+      bench_kernels (bench, wall_level (level_arena, scratch, bricks));
+      bench_update (bench, level_arena, scratch, bricks, "update", 1);
+      bench_update (bench, level_arena, scratch, bricks,
+                    "update_64_balls", 64);
+      bench_game_state (bench, level_arena, scratch, bricks);
+    }
+
+  finish_bench (bench);
+}
@@ -6,5 +6,8 @@
 typedef GLint glint;
 typedef GLuint gluint;
 typedef GLenum glenum;
+typedef GLsizei glsizei;
+typedef GLsync glsync;
+typedef GLbitfield glbitfield;
 
 #endif // GL_TYPES_HPP
@@ -0,0 +1,26 @@
+#include <cstdio>
+#include <cstdlib>
+
+#include "Level.hpp"
+
+// Converts a level, text or binary, to the binary form.
+int
+main (int argc, char **argv)
+{
+  if (argc != 3)
+    {
+      std::fprintf (stderr, "usage: %s INPUT OUTPUT\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  Arena arena = create_arena (LEVEL_ARENA_SIZE);
+  Arena scratch = create_arena (SCRATCH_ARENA_SIZE);
+  Level const level = load_level (arena, scratch, argv[1]);
+
+  save_binary_level (level, argv[2]);
+
+  std::printf ("%zu bricks, %dx%d grid\n",
+               level.blocks.count,
+               level.grid.columns,
+               level.grid.rows);
+}
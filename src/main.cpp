@@ -7,20 +7,156 @@
 #include <cassert>
 
 #include <GL/glew.h>
-#include <GL/glxew.h>
 
 #include "X11Window.hpp"
+#include "Arena.hpp"
 #include "Vectors.hpp"
 #include "AABB.hpp"
 #include "Breakout.hpp"
+#include "GameState.hpp"
+#include "FrameSnapshot.hpp"
+#include "RenderThread.hpp"
+#include "Timing.hpp"
+#include "Profiler.hpp"
+#include "Replay.hpp"
+#include "ShaderWatcher.hpp"
+#include "InputThread.hpp"
 #include "Utils.hpp"
 
 #define SCREEN_WIDTH 800
 #define SCREEN_HEIGHT 800
+#define TICKS_PER_SECOND 60
+#define PROFILE_INTERVAL_NS 1000000000
 
+struct Session
+{
+  Breakout game;
+  ReplayRecorder recorder;
+  bool is_recording;
+  // Restarting and loading saved states are not something replays can
+  // express, so recording sessions ignore them.
+  bool restart_requested;
+
+  // Quicksave slot, valid across restarts since the level stays the
+  // same. Empty while "saved_size" is zero.
+  void *saved_state;
+  size_t saved_size;
+
+  // Keys currently down, from the input thread's point of view.
+  bool left_held, right_held;
+
+  SnapshotBuffer *snapshots;
+  bool measure_latency;
+
+  ShaderWatcher shader_watcher;
+  bool shaders_changed;
+};
+
+static void
+apply_input (Session &session, Input input)
+{
+  if (session.is_recording)
+    record_input (session.recorder, session.game.tick, input);
+
+  handle_input (session.game, input);
+}
+
+// Applies the key changes read before "deadline", the real time the next
+// tick simulates up to, then the keys held down.
+static void
+consume_keys (Session &session,
+              X11Window &window,
+              KeyQueue &queue,
+              uint64_t deadline)
+{
+  for (const KeyEvent *event;
+       (event = peek (queue)) != NULL && event->time <= deadline;
+       pop (queue))
+    {
+      bool const affects_game =
+        event->keysym == XK_a || event->keysym == XK_d
+        || (event->keysym == XK_space && event->is_press);
+
+      if (session.measure_latency && affects_game)
+        note_input (*session.snapshots, event->time, session.game.tick);
+
+      switch (event->keysym)
+        {
+        case XK_a:
+          session.left_held = event->is_press;
+          break;
+        case XK_d:
+          session.right_held = event->is_press;
+          break;
+        case XK_space:
+          if (event->is_press)
+            apply_input (session, Input_SpawnBall);
+          break;
+        case XK_r:
+          if (event->is_press && !session.is_recording)
+            session.restart_requested = true;
+          break;
+        case XK_F5:
+          if (event->is_press)
+            session.saved_size =
+              save_game_state (session.game, session.saved_state);
+          break;
+        case XK_F9:
+          if (event->is_press && !session.is_recording
+              && session.saved_size != 0)
+            restore_game_state (session.game,
+                                session.saved_state,
+                                session.saved_size);
+          break;
+        case XK_Escape:
+          if (event->is_press)
+            window.should_close = true;
+          break;
+        }
+    }
+
+  // The slab moves once per tick while held, whatever the repeat rate.
+  if (session.left_held != session.right_held)
+    apply_input (session, session.left_held ? Input_Left : Input_Right);
+}
+
+// Usage: breakout [--level FILE] [--record FILE] [--shaders DIRECTORY]
+//                 [--latency]
+//
+// A and D move the slab, space launches another ball, R restarts the
+// level, F5 saves the game, F9 goes back to the save and escape quits.
+// With "--shaders" the built in shaders are replaced by the ones in
+// DIRECTORY whenever those change. "--latency" prints a histogram of
+// input to screen latency on exit.
 int
-main (void)
+main (int argc, char **argv)
 {
+  uint64_t const launch_time = now_ns ();
+  const char *level_path = NULL;
+  const char *record_path = NULL;
+  const char *shader_directory = NULL;
+  bool measure_latency = false;
+
+  for (int i = 1; i < argc; i++)
+    {
+      if (std::strcmp (argv[i], "--level") == 0 && i + 1 < argc)
+        level_path = argv[++i];
+      else if (std::strcmp (argv[i], "--record") == 0 && i + 1 < argc)
+        record_path = argv[++i];
+      else if (std::strcmp (argv[i], "--shaders") == 0 && i + 1 < argc)
+        shader_directory = argv[++i];
+      else if (std::strcmp (argv[i], "--latency") == 0)
+        measure_latency = true;
+      else
+        {
+          std::fprintf (stderr,
+                        "usage: %s [--level FILE] [--record FILE] "
+                        "[--shaders DIRECTORY] [--latency]\n",
+                        argv[0]);
+          std::exit (EXIT_FAILURE);
+        }
+    }
+
   X11Window window =
     create_x11_window (SCREEN_WIDTH, SCREEN_HEIGHT, "Hello World!");
 
@@ -30,60 +166,148 @@ main (void)
       std::exit (EXIT_FAILURE);
     }
 
-  Breakout game = create_breakout ();
+  uint64_t const seed = now_ns ();
+
+  // Everything the level and game need lives on "level_arena", so a
+  // restart is a reset and a reload. "scratch" is emptied every frame.
+  Arena level_arena = create_arena (LEVEL_ARENA_SIZE);
+  Arena scratch = create_arena (SCRATCH_ARENA_SIZE);
 
-  keyboard_context = (void *)&game;
-  keyboard_callback =
-    [](X11Window &window, KeySym keysym, void *data) -> void
+  auto start_game =
+    [&](uint64_t seed) -> Breakout
     {
-      Breakout &game = *(Breakout *)data;
+      return create_breakout (level_arena,
+                              level_path != NULL
+                              ? load_level (level_arena, scratch, level_path)
+                              : default_level (level_arena, scratch),
+                              seed);
+    };
 
-      bool should_update = false;
+  Session session;
+  session.game = start_game (seed);
+  session.is_recording = record_path != NULL;
+  session.restart_requested = false;
+  session.saved_state = malloc_or_exit (game_state_size (session.game));
+  session.saved_size = 0;
+  session.left_held = session.right_held = false;
+  session.measure_latency = measure_latency;
+  session.shaders_changed = false;
+  session.shader_watcher.fd = -1;
 
-      if (keysym == XK_a && game.slab.pos.x > -1)
-        {
-          game.slab.pos -= game.slab_vel;
-          should_update = true;
-        }
-      else if (keysym == XK_d && game.slab.pos.x + game.slab.shape.x < 1)
-        {
-          game.slab.pos += game.slab_vel;
-          should_update = true;
-        }
+  if (session.is_recording)
+    session.recorder = create_replay_recorder (record_path, seed);
+
+  Breakout &game = session.game;
+  session.snapshots = create_snapshot_buffer (level_arena, game);
+  publish (*session.snapshots, game, now_ns ());
+
+  InputThread *input = start_input_thread (window);
 
-      if (should_update)
+  if (shader_directory != NULL)
+    {
+      session.shader_watcher = create_shader_watcher (shader_directory);
+
+      watch_fd = session.shader_watcher.fd;
+      watch_context = (void *)&session;
+      watch_callback =
+        [](X11Window &, int, void *data) -> void
         {
-          glBindBuffer (GL_ARRAY_BUFFER, game.buffer[1]);
-          glBufferSubData (GL_ARRAY_BUFFER,
-                           Breakout::slab_offset,
-                           sizeof (AABB),
-                           &game.slab);
-        }
+          Session &session = *(Session *)data;
 
-      window.should_close = (keysym == XK_Escape);
-    };
+          session.shaders_changed |= shaders_changed (session.shader_watcher);
+        };
+    }
 
-  glClearColor (0.4, 0.4, 0.4, 1.0);
+  // "BREAKOUT_PROFILE=stderr" prints zone statistics, any other value is
+  // taken as the path of a CSV file to write them to.
+  FILE *profile_output = NULL;
 
-  for (glenum error; (error = glGetError ()) != GL_NO_ERROR; )
+  if (const char *profile = std::getenv ("BREAKOUT_PROFILE"))
     {
-      std::fprintf (stderr, "ERROR: detected OpenGL error: %i.\n", error);
+      bool const csv = std::strcmp (profile, "stderr") != 0;
+
+      profile_output = csv ? std::fopen (profile, "w") : stderr;
+
+      if (profile_output == NULL)
+        {
+          std::fprintf (stderr,
+                        "ERROR: failed to open file \'%s\'.\n",
+                        profile);
+          std::exit (EXIT_FAILURE);
+        }
+
+      start_profiling (profile_output, csv, PROFILE_INTERVAL_NS);
     }
 
-  if (GLX_EXT_swap_control)
-    glXSwapIntervalEXT (window.display, window.handle, 1);
+  FixedTimestep timestep = create_fixed_timestep (TICKS_PER_SECOND);
+  RenderThread *render = start_render_thread (window,
+                                              session.snapshots,
+                                              timestep.tick_ns,
+                                              shader_directory,
+                                              measure_latency,
+                                              launch_time);
 
+  // Ticks are published as they happen and drawn at whatever rate the
+  // display allows. In between this thread sleeps.
   while (!window.should_close)
     {
-      glClear (GL_COLOR_BUFFER_BIT);
+      uint32_t const ticks = advance (timestep);
 
-      update (game);
-      draw (game);
+      for (uint32_t left = ticks; left > 0; left--)
+        {
+          ScopedZone zone (Zone_Update);
+          consume_keys (session,
+                        window,
+                        input->queue,
+                        tick_end_time (timestep, left));
+          update (game);
+        }
+
+      if (ticks > 0)
+        publish (*session.snapshots, game, tick_end_time (timestep, 1));
+
+      {
+        ScopedZone zone (Zone_ProcessEvents);
+        process_events (window);
+      }
+
+      if (session.shaders_changed)
+        {
+          session.shaders_changed = false;
+          request_shader_reload (*render);
+        }
+
+      if (session.restart_requested)
+        {
+          session.restart_requested = false;
+          park_render_thread (*render);
+          reset_arena (level_arena);
+          game = start_game (now_ns ());
+          session.snapshots = create_snapshot_buffer (level_arena, game);
+          publish (*session.snapshots, game, now_ns ());
+          resume_render_thread (*render, session.snapshots);
+        }
+
+      reset_arena (scratch);
+      end_profiled_frame ();
+      sleep_until (next_tick_time (timestep));
+    }
 
-      glXSwapBuffers (window.display, window.handle);
+  stop_render_thread (render);
 
-      process_events (window);
+  if (profile_output != NULL)
+    {
+      stop_profiling ();
+
+      if (profile_output != stderr)
+        std::fclose (profile_output);
     }
 
+  if (session.is_recording)
+    finish_replay (session.recorder, game.tick);
+
+  stop_input_thread (input);
+  destroy_shader_watcher (session.shader_watcher);
   close (window);
+  std::free (session.saved_state);
 }
@@ -0,0 +1,128 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cinttypes>
+
+#include <GL/glew.h>
+
+#include "Arena.hpp"
+#include "Breakout.hpp"
+#include "Replay.hpp"
+#include "Timing.hpp"
+#include "FrameSnapshot.hpp"
+#include "Renderer.hpp"
+#include "OffscreenWindow.hpp"
+#include "FrameDumper.hpp"
+
+// Plays a recorded session back without a display and writes a frame
+// every "--every" ticks (1 by default) to files named after PATTERN, a
+// printf format taking the frame number such as "frames/%05d.png". The
+// first frame shows the level before the first tick. The level has to
+// be the one the session was recorded on.
+int
+main (int argc, char **argv)
+{
+  const char *level_path = NULL;
+  const char *positional[2] = { NULL, NULL };
+  int positional_count = 0;
+  unsigned width = 800, height = 800;
+  long every = 1;
+
+  for (int i = 1; i < argc; i++)
+    {
+      if (std::strcmp (argv[i], "--level") == 0 && i + 1 < argc)
+        level_path = argv[++i];
+      else if (std::strcmp (argv[i], "--size") == 0 && i + 1 < argc)
+        {
+          if (std::sscanf (argv[++i], "%ux%u", &width, &height) != 2)
+            width = 0;
+        }
+      else if (std::strcmp (argv[i], "--every") == 0 && i + 1 < argc)
+        every = std::atol (argv[++i]);
+      else if (positional_count < 2)
+        positional[positional_count++] = argv[i];
+      else
+        positional_count = 0;
+    }
+
+  if (positional_count != 2 || every <= 0 || width == 0 || height == 0)
+    {
+      std::fprintf (stderr,
+                    "usage: %s [--level FILE] [--size WIDTHxHEIGHT] "
+                    "[--every TICKS] REPLAY PATTERN\n",
+                    argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  Arena replay_arena = create_arena (SCRATCH_ARENA_SIZE);
+  Arena level_arena = create_arena (LEVEL_ARENA_SIZE);
+  Arena scratch = create_arena (SCRATCH_ARENA_SIZE);
+  Replay replay = load_replay (replay_arena, scratch, positional[0]);
+
+  Breakout game =
+    create_breakout (level_arena,
+                     level_path != NULL
+                     ? load_level (level_arena, scratch, level_path)
+                     : default_level (level_arena, scratch),
+                     replay.seed);
+
+  OffscreenWindow window = create_offscreen_window (width, height);
+  SnapshotBuffer *snapshots = create_snapshot_buffer (level_arena, game);
+  Renderer renderer = create_renderer (level_arena,
+                                       scratch,
+                                       snapshots->block_count,
+                                       snapshots->ball_capacity);
+  FrameDumper dumper =
+    create_frame_dumper (level_arena, positional[1], width, height);
+
+  glClearColor (0.4, 0.4, 0.4, 1.0);
+
+  size_t next_event = 0;
+  uint64_t const start = now_ns ();
+
+  for (;;)
+    {
+      if (game.tick % every == 0)
+        {
+          bool is_new;
+
+          publish (*snapshots, game, 0);
+          FrameSnapshot &snapshot = acquire (*snapshots, is_new);
+
+          glClear (GL_COLOR_BUFFER_BIT);
+          upload (renderer, snapshot, is_new, 1);
+          draw (renderer, snapshot);
+          swap_buffers (window);
+          capture_frame (dumper);
+        }
+
+      if (game.tick == replay.tick_count)
+        break;
+
+      for (; (next_event < replay.event_count
+              && replay.events[next_event].tick == game.tick);
+           next_event++)
+        handle_input (game, replay.events[next_event].input);
+
+      update (game);
+      reset_arena (scratch);
+    }
+
+  finish_frame_dumper (dumper);
+
+  double const seconds = (now_ns () - start) / 1e9;
+
+  std::printf ("frames: %" PRIu64 "\n", dumper.frame_count);
+  std::printf ("frames/s: %.1f\n",
+               seconds > 0 ? dumper.frame_count / seconds : 0.0);
+
+  for (glenum error; (error = glGetError ()) != GL_NO_ERROR; )
+    {
+      std::fprintf (stderr, "ERROR: detected OpenGL error: %i.\n", error);
+    }
+
+  // GL objects have to go while the context is still around.
+  dumper = FrameDumper ();
+  renderer = Renderer ();
+  close (window);
+}
@@ -0,0 +1,130 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cinttypes>
+#include <new>
+
+#include "Arena.hpp"
+#include "Breakout.hpp"
+#include "Replay.hpp"
+#include "Timing.hpp"
+#include "Utils.hpp"
+
+// C++ allocations are tracked too, so that a container sneaking into the
+// simulation fails the check below. The rest of operator new and delete
+// are the library's, which end up here or in free.
+void *
+operator new (std::size_t size)
+{
+  track_allocation ();
+
+  if (void *memory = std::malloc (size > 0 ? size : 1))
+    return memory;
+
+  throw std::bad_alloc ();
+}
+
+void
+operator delete (void *memory) noexcept
+{
+  std::free (memory);
+}
+
+// Replays a recorded session through the simulation as fast as possible
+// and reports throughput and the final state hash. The level has to be
+// the one the session was recorded on.
+int
+main (int argc, char **argv)
+{
+  const char *level_path = NULL;
+  const char *positional[2] = { NULL, NULL };
+  int positional_count = 0;
+
+  for (int i = 1; i < argc; i++)
+    {
+      if (std::strcmp (argv[i], "--level") == 0 && i + 1 < argc)
+        level_path = argv[++i];
+      else if (positional_count < 2)
+        positional[positional_count++] = argv[i];
+      else
+        positional_count = 0;
+    }
+
+  if (positional_count == 0)
+    {
+      std::fprintf (stderr,
+                    "usage: %s [--level FILE] REPLAY [REPETITIONS]\n",
+                    argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  Arena replay_arena = create_arena (SCRATCH_ARENA_SIZE);
+  Arena level_arena = create_arena (LEVEL_ARENA_SIZE);
+  Arena scratch = create_arena (SCRATCH_ARENA_SIZE);
+  Replay replay = load_replay (replay_arena, scratch, positional[0]);
+  long const repetitions =
+    positional_count == 2 ? std::atol (positional[1]) : 1;
+
+  size_t allocations = 0;
+  uint64_t hash = 0;
+  uint64_t elapsed = 0;
+
+  for (long r = 0; r < repetitions; r++)
+    {
+      reset_arena (level_arena);
+
+      Breakout game =
+        create_breakout (level_arena,
+                         level_path != NULL
+                         ? load_level (level_arena, scratch, level_path)
+                         : default_level (level_arena, scratch),
+                         replay.seed);
+      size_t next_event = 0;
+
+      uint64_t const start = now_ns ();
+
+      while (game.tick < replay.tick_count)
+        {
+          for (; (next_event < replay.event_count
+                  && replay.events[next_event].tick == game.tick);
+               next_event++)
+            handle_input (game, replay.events[next_event].input);
+
+          update (game);
+          game.dirty.count = 0;
+        }
+
+      elapsed += now_ns () - start;
+
+      uint64_t const game_hash = hash_state (game);
+
+      if (r > 0 && game_hash != hash)
+        {
+          std::fprintf (stderr,
+                        "ERROR: repetition %ld diverged.\n",
+                        r);
+          return EXIT_FAILURE;
+        }
+
+      // Reloading is meant to run entirely out of the arenas.
+      if (r > 0 && tracked_allocation_count () != allocations)
+        {
+          std::fprintf (stderr,
+                        "ERROR: repetition %ld allocated outside the "
+                        "arenas.\n",
+                        r);
+          return EXIT_FAILURE;
+        }
+
+      hash = game_hash;
+      allocations = tracked_allocation_count ();
+    }
+
+  double const seconds = elapsed / 1e9;
+  double const ticks = (double)replay.tick_count * repetitions;
+
+  std::printf ("ticks: %" PRIu64 "\n", replay.tick_count);
+  std::printf ("events: %zu\n", replay.event_count);
+  std::printf ("ticks/s: %.0f\n", seconds > 0 ? ticks / seconds : 0.0);
+  std::printf ("hash: %016" PRIx64 "\n", hash);
+}
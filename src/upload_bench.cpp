@@ -0,0 +1,146 @@
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include "Arena.hpp"
+#include "Utils.hpp"
+#include "Timing.hpp"
+#include "InstanceStream.hpp"
+#include "OffscreenWindow.hpp"
+#include "Bench.hpp"
+
+// Microbenchmarks of getting block instances to the GPU, on an offscreen
+// EGL context so they run without a display.
+
+#define UPLOAD_FRAMES 100
+// What a busy frame of the renderer uploads in "upload_changed_ranges":
+// CHANGED_RUNS runs of RUN_LENGTH blocks spread over the level.
+#define CHANGED_RUNS 16
+#define RUN_LENGTH 4
+
+// Ways of getting a frame's instances to the GPU. Each repetition is
+// UPLOAD_FRAMES frames then a glFinish, so the driver's copies count.
+static void
+bench_uploads (Bench &bench, Arena &arena, size_t bricks)
+{
+  Instance *instances =
+    (Instance *)malloc_or_exit (bricks * sizeof (Instance));
+
+  for (size_t i = 0; i < bricks; i++)
+    instances[i] = pack_instance ({ { 0, 0 }, { 0.1, 0.1 } },
+                                  BLOCK_COLOR,
+                                  1);
+
+  gluint name;
+  glCreateBuffers (1, &name);
+  GlBuffer buffer (name);
+  glNamedBufferData (buffer,
+                     bricks * sizeof (Instance),
+                     NULL,
+                     GL_DYNAMIC_DRAW);
+
+  measure (bench, "upload_sub_data", bricks, UPLOAD_FRAMES,
+           [&]()
+           {
+             uint64_t const start = now_ns ();
+
+             for (size_t i = 0; i < UPLOAD_FRAMES; i++)
+               glNamedBufferSubData (buffer,
+                                     0,
+                                     bricks * sizeof (Instance),
+                                     instances);
+
+             glFinish ();
+
+             return now_ns () - start;
+           });
+
+  measure (bench, "upload_orphan", bricks, UPLOAD_FRAMES,
+           [&]()
+           {
+             uint64_t const start = now_ns ();
+
+             for (size_t i = 0; i < UPLOAD_FRAMES; i++)
+               {
+                 glNamedBufferData (buffer,
+                                    bricks * sizeof (Instance),
+                                    NULL,
+                                    GL_DYNAMIC_DRAW);
+                 glNamedBufferSubData (buffer,
+                                       0,
+                                       bricks * sizeof (Instance),
+                                       instances);
+               }
+
+             glFinish ();
+
+             return now_ns () - start;
+           });
+
+  measure (bench, "upload_changed_ranges", bricks, UPLOAD_FRAMES,
+           [&]()
+           {
+             size_t const runs =
+               std::min ((size_t)CHANGED_RUNS, bricks / RUN_LENGTH);
+             uint64_t const start = now_ns ();
+
+             for (size_t i = 0; i < UPLOAD_FRAMES; i++)
+               for (size_t j = 0; j < runs; j++)
+                 {
+                   size_t const first = bricks / runs * j;
+
+                   glNamedBufferSubData (buffer,
+                                         first * sizeof (Instance),
+                                         RUN_LENGTH * sizeof (Instance),
+                                         instances + first);
+                 }
+
+             glFinish ();
+
+             return now_ns () - start;
+           });
+
+  // Through the stream the slab and balls use: persistently mapped
+  // segments if the driver has them.
+  {
+    ArenaScope scope (arena);
+    InstanceStream stream = create_instance_stream (arena, bricks);
+
+    std::memcpy (stream.shadow, instances, bricks * sizeof (Instance));
+
+    measure (bench, "upload_stream", bricks, UPLOAD_FRAMES,
+             [&]()
+             {
+               uint64_t const start = now_ns ();
+
+               for (size_t i = 0; i < UPLOAD_FRAMES; i++)
+                 {
+                   stream_dirty (stream, 0, bricks);
+                   flush (stream, bricks);
+                   end_frame (stream);
+                 }
+
+               glFinish ();
+
+               return now_ns () - start;
+             });
+  }
+
+  std::free (instances);
+}
+
+int
+main (int argc, char **argv)
+{
+  Bench bench = create_bench (argc, argv);
+  Arena scratch = create_arena (SCRATCH_ARENA_SIZE);
+  OffscreenWindow window = create_offscreen_window (64, 64);
+
+  for (size_t bricks : bench_brick_counts)
+    bench_uploads (bench, scratch, bricks);
+
+  close (window);
+  finish_bench (bench);
+}
@@ -0,0 +1,123 @@
+#include <cstdio>
+#include <cstdint>
+#include "BlockStore.hpp"
+#include "Tests.hpp"
+
+// xorshift64*, as the game uses, so failures reproduce.
+static uint64_t
+next_random (uint64_t &state)
+{
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+
+  return state * 0x2545f4914f6cdd1d;
+}
+
+// In "[0, bound[".
+static size_t
+random_below (uint64_t &state, size_t bound)
+{
+  return bound == 0 ? 0 : next_random (state) % bound;
+}
+
+// On a coarse grid of 1/16ths over "[-1, 1]", so that edges of boxes and
+// blocks often coincide and touching counts.
+static float
+random_coordinate (uint64_t &state)
+{
+  return (float)random_below (state, 33) / 16 - 1;
+}
+
+static AABB
+random_box (uint64_t &state)
+{
+  return { { random_coordinate (state), random_coordinate (state) },
+           { (float)random_below (state, 9) / 16,
+             (float)random_below (state, 9) / 16 } };
+}
+
+// Both kernels on "[first, last[", which have to find the same blocks in
+// the same order.
+static void
+compare_kernels (const BlockStore &store,
+                 const AABB &area,
+                 size_t first,
+                 size_t last,
+                 uint32_t *hits,
+                 uint32_t *scalar_hits)
+{
+  size_t const count = find_overlapping (store, area, first, last, hits);
+  size_t const scalar_count =
+    find_overlapping_scalar (store, area, first, last, scalar_hits);
+
+  if (!CHECK (count == scalar_count))
+    {
+      std::fprintf (stderr,
+                    "  %zu blocks, range [%zu, %zu[: %zu hits, scalar %zu\n",
+                    store.count, first, last, count, scalar_count);
+      return;
+    }
+
+  for (size_t i = 0; i < count; i++)
+    if (!CHECK (hits[i] == scalar_hits[i]))
+      {
+        std::fprintf (stderr,
+                      "  %zu blocks, range [%zu, %zu[: hit %zu is %u, "
+                      "scalar %u\n",
+                      store.count, first, last, i, hits[i], scalar_hits[i]);
+        return;
+      }
+}
+
+void
+test_block_store (void)
+{
+  size_t const max_count = 300;
+  Arena arena = create_arena ((size_t)1 << 24);
+  uint32_t *const hits =
+    (uint32_t *)push (arena, max_count * sizeof (uint32_t));
+  uint32_t *const scalar_hits =
+    (uint32_t *)push (arena, max_count * sizeof (uint32_t));
+  uint64_t state = 0x9e3779b97f4a7c15;
+
+  for (size_t round = 0; round < 400; round++)
+    {
+      ArenaScope scope (arena);
+      size_t const count = random_below (state, max_count + 1);
+      BlockStore store = create_block_store (arena, count);
+
+      for (size_t i = 0; i < count; i++)
+        set_block (store, i, random_box (state));
+
+      // Scattered deaths, then whole runs, so some alive words and
+      // SIMD lanes are entirely dead.
+      for (size_t i = 0; i < count; i++)
+        if (random_below (state, 4) == 0 && is_alive (store, i))
+          kill_block (store, i);
+
+      if (count != 0 && round % 2 == 0)
+        {
+          size_t const run_first = random_below (state, count);
+          size_t const run_last =
+            run_first + random_below (state, count - run_first + 1);
+
+          for (size_t i = run_first; i < run_last; i++)
+            if (is_alive (store, i))
+              kill_block (store, i);
+        }
+
+      for (size_t query = 0; query < 50; query++)
+        {
+          AABB const area = random_box (state);
+          size_t const first = random_below (state, count + 1);
+          size_t const last = first + random_below (state, count - first + 1);
+
+          compare_kernels (store, area, first, last, hits, scalar_hits);
+          compare_kernels (store, area, first, first, hits, scalar_hits);
+          compare_kernels (store, area, 0, count, hits, scalar_hits);
+        }
+    }
+
+  destroy_arena (arena);
+}
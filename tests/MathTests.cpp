@@ -0,0 +1,130 @@
+#include <cmath>
+#include <limits>
+#include "Vectors.hpp"
+#include "AABB.hpp"
+#include "Tests.hpp"
+
+// What is constexpr is checked at compile time as well.
+constexpr Vec2f a = { 1, 2 };
+constexpr Vec2f b = { 3, -4 };
+
+static_assert ((a + b).x == 4 && (a + b).y == -2, "operator+");
+static_assert ((a - b).x == -2 && (a - b).y == 6, "operator-");
+static_assert ((-a).x == -1 && (-a).y == -2, "unary operator-");
+static_assert ((a * b).x == 3 && (a * b).y == -8, "component-wise *");
+static_assert ((a * 2).x == 2 && (2 * a).y == 4, "scalar *");
+static_assert ((b / 2).x == 1.5f && (b / 2).y == -2, "operator/");
+static_assert (dot (a, b) == -5, "dot");
+static_assert (cross (a, b) == -10, "cross");
+static_assert (cross (a, a * 3) == 0, "cross of parallel vectors");
+static_assert (min (a, b).x == 1 && min (a, b).y == -4, "min");
+static_assert (max (a, b).x == 3 && max (a, b).y == 2, "max");
+static_assert (clamp ({ 5, -5 }, { 0, 0 }, { 1, 1 }).x == 1
+               && clamp ({ 5, -5 }, { 0, 0 }, { 1, 1 }).y == 0,
+               "clamp");
+
+constexpr float infinity = std::numeric_limits<float>::infinity ();
+
+// Parallel, and the same line twice: no single solution either way.
+static_assert (parametric_intersect ({ { 0, 0 }, { 1, 1 } },
+                                     { { 0, 1 }, { 2, 2 } }).x == infinity,
+               "parallel lines");
+static_assert (parametric_intersect ({ { 0, 0 }, { 1, 0 } },
+                                     { { 5, 0 }, { -1, 0 } }).y == infinity,
+               "collinear lines");
+static_assert (parametric_intersect ({ { 0, 0 }, { 1, 0 } },
+                                     { { 2, -1 }, { 0, 1 } }).x == 2
+               && parametric_intersect ({ { 0, 0 }, { 1, 0 } },
+                                        { { 2, -1 }, { 0, 1 } }).y == 1,
+               "crossing lines");
+
+constexpr AABB unit = { { 0, 0 }, { 1, 1 } };
+
+// Touching counts as intersecting, on edges and corners alike.
+static_assert (do_intersect (unit, { { 1, 0 }, { 1, 1 } }), "right edge");
+static_assert (do_intersect (unit, { { -1, 0 }, { 1, 1 } }), "left edge");
+static_assert (do_intersect (unit, { { 0, 1 }, { 1, 1 } }), "top edge");
+static_assert (do_intersect (unit, { { 1, 1 }, { 1, 1 } }), "corner");
+static_assert (!do_intersect (unit, { { 1.5f, 0 }, { 1, 1 } }), "apart");
+static_assert (do_intersect (unit, { { 0.25f, 0.25f }, { 0.5f, 0.5f } }),
+               "contained");
+static_assert (do_intersect ({ { 0.25f, 0.25f }, { 0.5f, 0.5f } }, unit),
+               "containing");
+static_assert (do_intersect (unit, { { 0.5f, 0.5f }, { 0, 0 } }),
+               "point inside");
+static_assert (do_intersect (unit, { { 1, 1 }, { 0, 0 } }),
+               "point on the corner");
+
+static bool
+equal (const Vec2f &x, const Vec2f &y)
+{
+  return x.x == y.x && x.y == y.y;
+}
+
+static void
+test_vectors (void)
+{
+  Vec2f v = a;
+
+  v += b;
+  CHECK (equal (v, { 4, -2 }));
+  v -= a;
+  CHECK (equal (v, b));
+  v *= 0.5f;
+  CHECK (equal (v, { 1.5f, -2 }));
+
+  CHECK (length ({ 3, 4 }) == 5);
+  CHECK (equal (normalize ({ 0, 0 }), { 0, 0 }));
+  CHECK (equal (normalize ({ 0, -2 }), { 0, -1 }));
+
+  Vec2f const n = normalize (b);
+
+  CHECK (std::fabs (length (n) - 1) < 1e-6f);
+  CHECK (equal (n, { 0.6f, -0.8f }));
+
+  Vec2f const parallel =
+    parametric_intersect ({ { 0, 0 }, { 0, 1 } }, { { 1, 0 }, { 0, -3 } });
+
+  CHECK (std::isinf (parallel.x) && std::isinf (parallel.y));
+}
+
+static void
+test_boxes (void)
+{
+  AABB const ball = { { 0.25f, -1 }, { 0.5f, 0.5f } };
+  Contact contact;
+
+  // Resting on the face it moves along, or moving away from it.
+  CHECK (!sweep ({ { 1, 0 }, { 1, 1 } }, { 0, 0.5f }, unit, &contact));
+  CHECK (!sweep ({ { 1, 0 }, { 1, 1 } }, { 0.5f, 0 }, unit, &contact));
+
+  // Touching by the end of the move.
+  CHECK (sweep (ball, { 0, 0.5f }, unit, &contact));
+  CHECK (contact.time == 1);
+  CHECK (equal (contact.normal, { 0, -1 }));
+
+  // Falling short by a little.
+  CHECK (!sweep (ball, { 0, 0.25f }, unit, &contact));
+
+  // Already overlapping and pushing further in.
+  CHECK (sweep ({ { 0.9f, 0.25f }, { 0.5f, 0.5f } },
+                { -0.1f, 0 },
+                unit,
+                &contact));
+  CHECK (contact.time == 0);
+  CHECK (equal (contact.normal, { 1, 0 }));
+
+  // Corner on corner.
+  CHECK (sweep ({ { -1, -1 }, { 0.5f, 0.5f } },
+                { 0.5f, 0.5f },
+                unit,
+                &contact));
+  CHECK (equal (contact.normal, { -1, -1 }));
+}
+
+void
+test_math (void)
+{
+  test_vectors ();
+  test_boxes ();
+}
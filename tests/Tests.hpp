@@ -0,0 +1,18 @@
+#ifndef TESTS_HPP
+#define TESTS_HPP
+
+// Checks report where they failed and let the test go on, so one run
+// lists every failure. "tests" exits with failure if any check did.
+#define CHECK(condition) check ((condition), #condition, __FILE__, __LINE__)
+
+bool
+check (bool condition, const char *text, const char *file, int line);
+
+// One function per tested module.
+void
+test_block_store (void);
+
+void
+test_math (void);
+
+#endif // TESTS_HPP
@@ -0,0 +1,34 @@
+#include <cstdio>
+#include <cstdlib>
+#include "Tests.hpp"
+
+static size_t failure_count = 0;
+
+bool
+check (bool condition, const char *text, const char *file, int line)
+{
+  if (!condition)
+    {
+      std::fprintf (stderr, "%s:%d: check failed: %s\n", file, line, text);
+      failure_count++;
+    }
+
+  return condition;
+}
+
+int
+main (void)
+{
+  test_block_store ();
+  test_math ();
+
+  if (failure_count != 0)
+    {
+      std::fprintf (stderr, "%zu checks failed.\n", failure_count);
+      return EXIT_FAILURE;
+    }
+
+  std::printf ("All checks passed.\n");
+
+  return EXIT_SUCCESS;
+}